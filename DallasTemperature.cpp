@@ -16,6 +16,7 @@ extern "C" {
 #define RECALLSCRATCH   0xB8  // Recall from EEPROM to scratchpad
 #define READPOWERSUPPLY 0xB4  // Determine if device needs parasite power
 #define ALARMSEARCH     0xEC  // Query bus for devices with an alarm condition
+#define SEARCHROM       0xF0  // Query bus for device addresses
 
 // Scratchpad locations
 #define TEMP_LSB        0
@@ -40,6 +41,23 @@ extern "C" {
 #define DSROM_FAMILY    0
 #define DSROM_CRC       7
 
+// saveDeviceTable() layout: a header, then one record per table entry,
+// each closed by its CRC. Counts are 16 bit little endian whatever the
+// DEVICE_INDEX_BITS of the build.
+#define TABLE_HEADER_SIZE   12
+#define TABLE_RECORD_SIZE   14
+#define TABLE_FLAG_PARASITE 0x01
+#define TABLE_FLAG_FAMILY   0x02  // header: built by a family search
+#define TABLE_FLAG_FOREIGN  0x04  // header: the search passed over other devices
+#define TABLE_FLAG_SHADOW   0x02  // record: the shadow matches the device
+
+// readScratchPadChecked() and readTemperatureFast() results
+#define SCRATCHPAD_READ_OK          0
+#define SCRATCHPAD_READ_ABSENT      1  // no presence pulse, or nothing answered
+#define SCRATCHPAD_READ_CRC_ERROR   2
+#define SCRATCHPAD_READ_IMPLAUSIBLE 3
+#define SCRATCHPAD_READ_UNSUPPORTED 4  // family needs the full scratchpad
+
 DallasTemperature::DallasTemperature() {
     _wire = nullptr;
     devices = 0;
@@ -49,12 +67,63 @@ DallasTemperature::DallasTemperature() {
     waitForConversion = true;
     checkForConversion = true;
     autoSaveScratchPad = true;
+    deferredWrites = false;
+    familySearch = false;
+    foreignDevices = false;
+    readMode = READ_FULL;
     useExternalPullup = false;
+    deviceTable = nullptr;
+    deviceTableSize = 0;
+    cachedDevices = 0;
+    lookupHint = 0;
+    readingTable = nullptr;
+    conversionState = CONVERSION_IDLE;
+    conversionIndex = 0;
+    conversionTier = 9;
+    conversionPolled = true;
+    conversionRequest = {};
+#if REQUIRESROLLING
+    rollingDevices = 0;
+    rollingStartIndex = 0;
+    rollingReadIndex = 0;
+    rollingGroups = 0;
+    rollingStarting = 0;
+    rollingReading = 0;
+    rollingInFlight = 0;
+#endif
+    learnConversionTime = true;
+    conversionScale = 0;
+    pollResolution = 12;
+    pollStart = 0;
+    pollBroadcast = false;
+    pollBusyAt = 0;
+    pollBusy = false;
+    _TemperatureHandler = nullptr;
+    _DeviceChangeHandler = nullptr;
+    _clock = nullptr;
+#if REQUIRESEEPROMQUEUE
+    eepromHead = 0;
+    eepromCount = 0;
+    eepromRunning = false;
+    eepromPolled = false;
+    eepromStart = 0;
+    waitForEeprom = true;
+    _EepromHandler = nullptr;
+#endif
+#if REQUIRESHEALTH
+    quarantineThreshold = QUARANTINE_THRESHOLD;
+#endif
+#if REQUIRESSCHEDULE
+    broadcastPercent = SCHEDULE_BROADCAST_PERCENT;
+#endif
 #if REQUIRESALARMS
     setAlarmHandler(NO_ALARM_HANDLER);
     alarmSearchJunction = -1;
     alarmSearchExhausted = 0;
 #endif
+#if REQUIRESBUSSTATS
+    resetBusStats();
+#endif
 }
 
 DallasTemperature::DallasTemperature(OneWire* _oneWire) : DallasTemperature() {
@@ -69,6 +138,8 @@ void DallasTemperature::setOneWire(OneWire* _oneWire) {
     _wire = _oneWire;
     devices = 0;
     ds18Count = 0;
+    cachedDevices = 0;
+    conversionState = CONVERSION_IDLE;
     parasite = false;
     bitResolution = 9;
     waitForConversion = true;
@@ -85,30 +156,36 @@ void DallasTemperature::setPullupPin(uint8_t _pullupPin) {
 
 void DallasTemperature::begin(void) {
     DeviceAddress deviceAddress;
+    DeviceInfo* table = getDeviceTable();
+    DeviceIndex tableSize = getDeviceTableSize();
     
     for (uint8_t retry = 0; retry < MAX_INITIALIZATION_RETRIES; retry++) {
-        _wire->reset_search();
+        resetSearch();
         devices = 0;
         ds18Count = 0;
+        cachedDevices = 0;
+        foreignDevices = false;
         
-        delay(INITIALIZATION_DELAY_MS);
+        clockWait(INITIALIZATION_DELAY_MS);
         
-        while (_wire->search(deviceAddress)) {
+        while (searchNext(deviceAddress)) {
             if (validAddress(deviceAddress)) {
-                devices++;
+                if (validFamily(deviceAddress)) ds18Count++;
                 
-                if (validFamily(deviceAddress)) {
-                    ds18Count++;
-                    
+                if (devices < tableSize) {
+                    DeviceInfo& info = table[cachedDevices++];
+                    probeDevice(&info, deviceAddress);
+                    if (info.parasite) parasite = true;
+                    if (waitResolution(&info) > bitResolution) bitResolution = waitResolution(&info);
+                } else if (validFamily(deviceAddress)) {
+                    // past the table we only need to know if any is parasite
                     if (!parasite && readPowerSupply(deviceAddress)) {
                         parasite = true;
                     }
-                    
                     uint8_t b = getResolution(deviceAddress);
-                    if (b > bitResolution) {
-                        bitResolution = b;
-                    }
+                    if (b > bitResolution) bitResolution = b;
                 }
+                devices++;
             }
         }
         
@@ -116,6 +193,348 @@ void DallasTemperature::begin(void) {
     }
 }
 
+// Fill in a table entry for a device found by a search: one power supply
+// query and one scratchpad read, which gives the resolution and the shadow
+void DallasTemperature::probeDevice(DeviceInfo* info, const uint8_t* deviceAddress) {
+    ScratchPad scratchPad;
+    
+    memcpy(info->address, deviceAddress, sizeof(DeviceAddress));
+    info->resolution = 0;
+    info->parasite = false;
+    info->shadowValid = false;
+    info->dirty = false;
+#if REQUIRESHEALTH
+    memset(&info->health, 0, sizeof(DeviceHealth));
+#endif
+#if REQUIRESSCHEDULE
+    memset(&info->schedule, 0, sizeof(DeviceSchedule));
+#endif
+    Reading none = { DEVICE_DISCONNECTED_RAW, 0, READING_DISCONNECTED, false };
+    storeReading(info, none);
+    if (!validFamily(deviceAddress)) return;
+    
+    info->parasite = readPowerSupply(deviceAddress);
+    if (isConnected(deviceAddress, scratchPad)) {
+        info->resolution = decodeResolution(deviceAddress, scratchPad);
+        updateShadow(info, scratchPad);
+    } else if (isFamily(deviceAddress, DS18S20MODEL)) {
+        info->resolution = 12;
+    }
+}
+
+// Warm start from a table written by saveDeviceTable(). Every restored
+// thermometer is checked with one short scratchpad read, and any other
+// device by its ROM, instead of a search, a power supply query and a full
+// read each. When the storage is empty or corrupt, or any device does not
+// answer as saved, this falls back to begin(). Returns true when the saved
+// table was used. Devices added since the save are not seen,
+// scanForChanges() finds them.
+bool DallasTemperature::begin(Storage* storage) {
+    if (restoreDeviceTable(storage)) return true;
+    
+    parasite = false;
+    bitResolution = 9;
+    begin();
+    return false;
+}
+
+bool DallasTemperature::restoreDeviceTable(Storage* storage) {
+    DeviceInfo* table = getDeviceTable();
+    uint8_t header[TABLE_HEADER_SIZE];
+    uint8_t record[TABLE_RECORD_SIZE];
+    
+    if (storage == nullptr || !storage->read(0, header, sizeof(header))) return false;
+    if (header[0] != 'D' || header[1] != 'T' || header[2] != DEVICE_TABLE_FORMAT) return false;
+    if (_wire->crc8(header, TABLE_HEADER_SIZE - 1) != header[TABLE_HEADER_SIZE - 1]) return false;
+    if (((header[9] & TABLE_FLAG_FAMILY) != 0) != familySearch) return false;
+    
+    foreignDevices = (header[9] & TABLE_FLAG_FOREIGN) != 0;
+    uint16_t saved = header[3] | (header[4] << 8);
+    uint16_t savedDevices = header[5] | (header[6] << 8);
+    uint16_t savedDS18 = header[7] | (header[8] << 8);
+    // a bus this build cannot count needs a search
+    if (savedDevices != (DeviceIndex)savedDevices) return false;
+    if (saved > getDeviceTableSize() || saved > savedDevices) return false;
+    
+    cachedDevices = 0;
+    for (DeviceIndex i = 0; i < saved; i++) {
+        uint16_t offset = TABLE_HEADER_SIZE + (uint16_t)i * TABLE_RECORD_SIZE;
+        if (!storage->read(offset, record, sizeof(record))) return false;
+        if (_wire->crc8(record, TABLE_RECORD_SIZE - 1) != record[TABLE_RECORD_SIZE - 1]) return false;
+        
+        DeviceInfo& info = table[i];
+        memcpy(info.address, record, sizeof(DeviceAddress));
+        info.resolution = record[8];
+        info.parasite = (record[9] & TABLE_FLAG_PARASITE) != 0;
+        info.shadowValid = (record[9] & TABLE_FLAG_SHADOW) != 0;
+        info.dirty = false;
+        memcpy(info.shadow, &record[10], 3);
+#if REQUIRESHEALTH
+        memset(&info.health, 0, sizeof(DeviceHealth));
+#endif
+#if REQUIRESSCHEDULE
+        memset(&info.schedule, 0, sizeof(DeviceSchedule));
+#endif
+        Reading none = { DEVICE_DISCONNECTED_RAW, 0, READING_DISCONNECTED, false };
+        storeReading(&info, none);
+        if (!verifyDevice(&info)) return false;
+    }
+    
+    cachedDevices = saved;
+    devices = savedDevices;
+    ds18Count = savedDS18;
+    bitResolution = header[10];
+    // one Skip ROM query confirms the power mode of a bus of thermometers,
+    // its reset ends the last read; other buses keep the saved mode
+    if (tableCoversBus() && ds18Count == cachedDevices) {
+        parasite = readPowerSupply();
+    } else {
+        parasite = (header[9] & TABLE_FLAG_PARASITE) != 0;
+        busReset();
+    }
+    return true;
+}
+
+// Presence check for a restored entry: reading up to the configuration
+// byte returns TH, TL and configuration, which have to match the shadow.
+// Ends without a reset, the next transaction's reset closes the read.
+bool DallasTemperature::verifyDevice(const DeviceInfo* info) {
+    ScratchPad scratchPad;
+    
+    // other families may not know READSCRATCH, or use 0xBE for something else
+    if (!validFamily(info->address)) return romPresent(info->address);
+    if (!readScratchPadBytes(info->address, scratchPad, CONFIGURATION + 1)) return false;
+    
+    uint8_t ones = 0xFF;
+    for (uint8_t i = 0; i <= CONFIGURATION; i++) ones &= scratchPad[i];
+    if (ones == 0xFF || isAllZeros(scratchPad, CONFIGURATION + 1)) return false;
+    if (!info->shadowValid) return true;
+    
+    if (scratchPad[HIGH_ALARM_TEMP] != info->shadow[0] || scratchPad[LOW_ALARM_TEMP] != info->shadow[1])
+        return false;
+    return isFamily(info->address, DS18S20MODEL) || scratchPad[CONFIGURATION] == info->shadow[2];
+}
+
+// ROM level presence check: a search that only ever follows the bits of
+// deviceAddress reaches its end when that device is on the bus. No
+// function command is sent. Ends without a reset, like verifyDevice().
+bool DallasTemperature::romPresent(const uint8_t* deviceAddress) {
+    if (busReset() == 0) return false;
+    busWrite(SEARCHROM);
+    
+    for (uint8_t i = 0; i < 64; i++) {
+        uint8_t bit = (deviceAddress[i / 8] >> (i & 7)) & 1;
+        uint8_t a = _wire->read_bit();
+        uint8_t nota = _wire->read_bit();
+        // a device with this bit pulls its slot low
+        if (bit ? nota : a) return false;
+        _wire->write_bit(bit);
+    }
+    return true;
+}
+
+// Write the address table for a later begin(Storage*), which needs
+// deviceTableStorageSize(n) bytes for n devices. Staged edits that were
+// not committed are saved as unknown, not as the device's contents.
+bool DallasTemperature::saveDeviceTable(Storage* storage) {
+    DeviceInfo* table = getDeviceTable();
+    uint8_t header[TABLE_HEADER_SIZE];
+    uint8_t record[TABLE_RECORD_SIZE];
+    
+    // a save cut short must not leave the old header in front of new records
+    header[0] = 0;
+    if (storage == nullptr || !storage->write(0, header, 1)) return false;
+    
+    header[0] = 'D';
+    header[1] = 'T';
+    header[2] = DEVICE_TABLE_FORMAT;
+    header[3] = cachedDevices & 0xFF;
+    header[4] = (uint16_t)cachedDevices >> 8;
+    header[5] = devices & 0xFF;
+    header[6] = (uint16_t)devices >> 8;
+    header[7] = ds18Count & 0xFF;
+    header[8] = (uint16_t)ds18Count >> 8;
+    header[9] = (parasite ? TABLE_FLAG_PARASITE : 0) | (familySearch ? TABLE_FLAG_FAMILY : 0)
+                | (foreignDevices ? TABLE_FLAG_FOREIGN : 0);
+    header[10] = bitResolution;
+    header[11] = _wire->crc8(header, TABLE_HEADER_SIZE - 1);
+    
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        const DeviceInfo& info = table[i];
+        memcpy(record, info.address, sizeof(DeviceAddress));
+        record[8] = info.resolution;
+        record[9] = (info.parasite ? TABLE_FLAG_PARASITE : 0)
+                    | ((info.shadowValid && !info.dirty) ? TABLE_FLAG_SHADOW : 0);
+        memcpy(&record[10], info.shadow, 3);
+        record[13] = _wire->crc8(record, TABLE_RECORD_SIZE - 1);
+        
+        uint16_t offset = TABLE_HEADER_SIZE + (uint16_t)i * TABLE_RECORD_SIZE;
+        if (!storage->write(offset, record, sizeof(record))) return false;
+    }
+    return storage->write(0, header, sizeof(header));
+}
+
+uint16_t DallasTemperature::deviceTableStorageSize(DeviceIndex count) {
+    return TABLE_HEADER_SIZE + (uint16_t)count * TABLE_RECORD_SIZE;
+}
+
+// Forget what the last begin() learned and search the bus again
+DeviceIndex DallasTemperature::rescan(void) {
+    parasite = false;
+    bitResolution = 9;
+    begin();
+    return devices;
+}
+
+// Hot-plug check: one search pass compared against the address table, which
+// begin() fills in search order. Devices still there are not touched again;
+// new ones are probed and inserted where the search found them, gone ones
+// are dropped, and each change is passed to the device change handler.
+// Returns the number of changes. Changes are exact while the table holds
+// every device; past it only the counts follow the bus, and devices that
+// move into the table after a removal are reported as new.
+DeviceIndex DallasTemperature::scanForChanges(void) {
+    DeviceInfo* table = getDeviceTable();
+    DeviceIndex tableSize = getDeviceTableSize();
+    DeviceAddress deviceAddress;
+    DeviceIndex index = 0;     // next table entry to match
+    DeviceIndex found = 0;
+    DeviceIndex thermometers = 0;
+    DeviceIndex changes = 0;
+    bool removed = false;
+    
+    resetSearch();
+    foreignDevices = false;
+    for (;;) {
+        bool more = searchNext(deviceAddress);
+        if (more && !validAddress(deviceAddress)) continue;
+        
+        // table entries the search has passed without finding are gone
+        while (index < cachedDevices && (!more || searchOrder(table[index].address, deviceAddress) < 0)) {
+            if (_DeviceChangeHandler != nullptr) _DeviceChangeHandler(table[index].address, false);
+            moveEntries(index, index + 1, cachedDevices - index - 1);
+            cachedDevices--;
+            changes++;
+            removed = true;
+        }
+        if (!more) break;
+        
+        if (validFamily(deviceAddress)) thermometers++;
+        found++;
+        
+        if (index < cachedDevices && memcmp(table[index].address, deviceAddress, sizeof(DeviceAddress)) == 0) {
+            index++;
+        } else if (index < tableSize) {
+            // a full table pushes its last entry past the end, still on the bus
+            if (cachedDevices == tableSize) cachedDevices--;
+            moveEntries(index + 1, index, cachedDevices - index);
+            cachedDevices++;
+            
+            DeviceInfo& info = table[index++];
+            probeDevice(&info, deviceAddress);
+            if (info.parasite) parasite = true;
+            if (waitResolution(&info) > bitResolution) bitResolution = waitResolution(&info);
+            if (_DeviceChangeHandler != nullptr) _DeviceChangeHandler(info.address, true);
+            changes++;
+        }
+    }
+    
+    devices = found;
+    ds18Count = thermometers;
+    if (changes == 0) return 0;
+    
+    if (cachedDevices == devices) {
+        parasite = false;
+        for (DeviceIndex i = 0; i < cachedDevices; i++) {
+            if (table[i].parasite) parasite = true;
+        }
+        updateBitResolution();
+    } else if (removed) {
+        // one Skip ROM query covers the devices outside the table
+        parasite = readPowerSupply();
+    }
+    return changes;
+}
+
+void DallasTemperature::setDeviceChangeHandler(DeviceChangeHandler* handler) {
+    _DeviceChangeHandler = handler;
+}
+
+// Move count table entries, and their latest readings, from one index
+// to another
+void DallasTemperature::moveEntries(DeviceIndex to, DeviceIndex from, DeviceIndex count) {
+    DeviceInfo* table = getDeviceTable();
+    memmove(&table[to], &table[from], count * sizeof(DeviceInfo));
+    if (readingTable != nullptr) {
+        memmove(&readingTable[to], &readingTable[from], count * sizeof(Reading));
+    }
+}
+
+// Order in which a ROM search finds two addresses: bits are compared from
+// the least significant bit of the family code up, and 0 is taken first
+int8_t DallasTemperature::searchOrder(const uint8_t* a, const uint8_t* b) {
+    for (uint8_t i = 0; i < 8; i++) {
+        uint8_t diff = a[i] ^ b[i];
+        if (diff != 0) {
+            diff &= -diff;
+            return (a[i] & diff) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+// Use a caller supplied address table instead of the built-in one.
+// Takes effect on the next begin() or rescan().
+void DallasTemperature::setDeviceTable(DeviceInfo* table, DeviceIndex size) {
+    deviceTable = table;
+    deviceTableSize = (table == nullptr) ? 0 : size;
+    cachedDevices = 0;
+    lookupHint = 0;
+    readingTable = nullptr;
+}
+
+DallasTemperature::DeviceInfo* DallasTemperature::getDeviceTable(void) {
+#if DEVICE_CACHE_SIZE > 0
+    if (deviceTable == nullptr) return deviceCache;
+#endif
+    return deviceTable;
+}
+
+DeviceIndex DallasTemperature::getDeviceTableSize(void) {
+    if (deviceTable == nullptr) return DEVICE_CACHE_SIZE;
+    return deviceTableSize;
+}
+
+// Time source and waits for an RTOS, a sleeping CPU or simulated time.
+// nullptr goes back to millis(), delay() and yield().
+void DallasTemperature::setClock(Clock* clock) {
+    _clock = clock;
+}
+
+DallasTemperature::Clock* DallasTemperature::getClock(void) {
+    return _clock;
+}
+
+unsigned long DallasTemperature::clockNow(void) {
+    if (_clock != nullptr) return _clock->now();
+    return millis();
+}
+
+void DallasTemperature::clockWait(unsigned long ms) {
+    if (_clock != nullptr)
+        _clock->wait(ms);
+    else
+        delay(ms);
+}
+
+// Called between status polls; a clock may sleep here for a little while
+void DallasTemperature::clockIdle(void) {
+    if (_clock != nullptr)
+        _clock->idle();
+    else
+        yield();
+}
+
 void DallasTemperature::activateExternalPullup() {
     if (useExternalPullup) digitalWrite(pullupPin, LOW);
 }
@@ -125,29 +544,132 @@ void DallasTemperature::deactivateExternalPullup() {
 }
 
 bool DallasTemperature::validFamily(const uint8_t* deviceAddress) {
-    switch (deviceAddress[0]) {
-        case DS18S20MODEL:
-        case DS18B20MODEL:
-        case DS1822MODEL:
-        case DS1825MODEL:
-        case DS28EA00MODEL:
-            return true;
-        default:
-            return false;
+    return supportsFamily(deviceAddress[0]);
+}
+
+// True when the low bits of some supported family code equal prefix
+bool DallasTemperature::validFamilyPrefix(uint8_t prefix, uint8_t bits) {
+    static const uint8_t families[] = {
+        DS18S20MODEL, DS18B20MODEL, DS1822MODEL, DS1825MODEL, DS28EA00MODEL
+    };
+    uint8_t mask = (bits >= 8) ? 0xFF : (uint8_t)((1 << bits) - 1);
+    for (uint8_t i = 0; i < sizeof(families); i++) {
+        if (supportsFamily(families[i]) && (families[i] & mask) == (prefix & mask)) return true;
+    }
+    return false;
+}
+
+// Only walk the temperature families when searching the bus. Switches,
+// EEPROMs and other devices then cost no search time, and are left out of
+// getDeviceCount() and the index. Takes effect on the next begin().
+void DallasTemperature::setFamilySearch(bool flag) {
+    familySearch = flag;
+}
+
+bool DallasTemperature::getFamilySearch(void) {
+    return familySearch;
+}
+
+void DallasTemperature::resetSearch(void) {
+    if (!familySearch) {
+        _wire->reset_search();
+        return;
+    }
+    searchJunction = -1;
+    searchExhausted = false;
+    memset(searchAddress, 0, sizeof(DeviceAddress));
+}
+
+// Next device of the bus walk, in the order of OneWire::search(). With
+// family search the family code bits are pruned as they are read: a
+// branch no supported family starts with is never taken nor remembered,
+// so a walk ends after the last thermometer. A forced bit into such a
+// subtree backtracks to the last open branch with a new search.
+bool DallasTemperature::searchNext(uint8_t* deviceAddress) {
+    if (!familySearch) return _wire->search(deviceAddress);
+    
+    while (!searchExhausted) {
+        if (busReset() == 0) break;
+        busWrite(SEARCHROM);
+        
+        int8_t lastZero = -1;
+        bool pruned = false;
+        for (uint8_t i = 0; i < 64; i++) {
+            uint8_t ibyte = i / 8;
+            uint8_t ibit = 1 << (i & 7);
+            uint8_t a = _wire->read_bit();
+            uint8_t nota = _wire->read_bit();
+            
+            if (a && nota) {
+                // nobody answered, the walk is over
+                searchExhausted = true;
+                break;
+            }
+            
+            uint8_t direction;
+            bool branch = !a && !nota;
+            if (!branch) {
+                direction = a;
+            } else if (i < searchJunction) {
+                direction = (searchAddress[ibyte] & ibit) ? 1 : 0;
+            } else {
+                direction = (i == searchJunction) ? 1 : 0;
+            }
+            
+            if (i < 8) {
+                uint8_t prefix = searchAddress[0] & (ibit - 1);
+                bool viable0 = validFamilyPrefix(prefix, i + 1);
+                bool viable1 = validFamilyPrefix(prefix | ibit, i + 1);
+                if (branch && !(viable0 && viable1)) {
+                    // only one side holds thermometers
+                    foreignDevices = true;
+                    branch = false;
+                    direction = viable1 ? 1 : 0;
+                } else if (!branch && !(direction ? viable1 : viable0)) {
+                    foreignDevices = true;
+                    pruned = true;
+                    break;
+                }
+            }
+            
+            if (branch && direction == 0) lastZero = i;
+            if (direction)
+                searchAddress[ibyte] |= ibit;
+            else
+                searchAddress[ibyte] &= ~ibit;
+            _wire->write_bit(direction);
+        }
+        if (searchExhausted) break;
+        
+        searchJunction = lastZero;
+        if (lastZero < 0) searchExhausted = true;
+        if (pruned) continue;
+        
+        memcpy(deviceAddress, searchAddress, sizeof(DeviceAddress));
+        return true;
     }
+    searchExhausted = true;
+    return false;
 }
 
 bool DallasTemperature::validAddress(const uint8_t* deviceAddress) {
     return (_wire->crc8(const_cast<uint8_t*>(deviceAddress), 7) == deviceAddress[7]);
 }
 
-bool DallasTemperature::getAddress(uint8_t* deviceAddress, uint8_t index) {
+bool DallasTemperature::getAddress(uint8_t* deviceAddress, DeviceIndex index) {
+    if (index < cachedDevices) {
+        memcpy(deviceAddress, getDeviceTable()[index].address, sizeof(DeviceAddress));
+        // index based calls look the address up next
+        lookupHint = index;
+        return true;
+    }
+    
     if (index < devices) {
-        uint8_t depth = 0;
+        DeviceIndex depth = 0;
         
-        _wire->reset_search();
+        resetSearch();
         
-        while (depth <= index && _wire->search(deviceAddress)) {
+        while (depth <= index && searchNext(deviceAddress)) {
             if (depth == index && validAddress(deviceAddress)) {
                 return true;
             }
@@ -157,11 +679,16 @@ bool DallasTemperature::getAddress(uint8_t* deviceAddress, uint8_t index) {
     return false;
 }
 
-uint8_t DallasTemperature::getDeviceCount(void) {
+const DallasTemperature::DeviceInfo* DallasTemperature::getDeviceInfo(DeviceIndex index) {
+    if (index < cachedDevices) return &getDeviceTable()[index];
+    return nullptr;
+}
+
+DeviceIndex DallasTemperature::getDeviceCount(void) {
     return devices;
 }
 
-uint8_t DallasTemperature::getDS18Count(void) {
+DeviceIndex DallasTemperature::getDS18Count(void) {
     return ds18Count;
 }
 
@@ -171,24 +698,58 @@ bool DallasTemperature::isConnected(const uint8_t* deviceAddress) {
 }
 
 bool DallasTemperature::isConnected(const uint8_t* deviceAddress, uint8_t* scratchPad) {
-    bool b = readScratchPad(deviceAddress, scratchPad);
-    return b && !isAllZeros(scratchPad) && (_wire->crc8(scratchPad, 8) == scratchPad[SCRATCHPAD_CRC]);
+    uint8_t result = readScratchPadChecked(deviceAddress, scratchPad);
+    if (result == SCRATCHPAD_READ_ABSENT) return false;
+    busReset();
+    return result == SCRATCHPAD_READ_OK;
+}
+
+// Read and check the scratchpad without the trailing reset. A missing
+// device leaves the bus high and a shorted one holds it low, so for
+// families with a configuration register the read stops at that byte when
+// it is 0xFF or 0x00 instead of clocking the remaining four. No device is
+// left talking when the result is SCRATCHPAD_READ_ABSENT.
+uint8_t DallasTemperature::readScratchPadChecked(const uint8_t* deviceAddress, uint8_t* scratchPad) {
+    if (busReset() == 0) return SCRATCHPAD_READ_ABSENT;
+    
+    busSelect(deviceAddress);
+    busWrite(READSCRATCH);
+    
+    bool configured = (isFamily(deviceAddress, DS18B20MODEL) || isFamily(deviceAddress, DS1822MODEL)
+                       || isFamily(deviceAddress, DS28EA00MODEL));
+    uint8_t ones = 0xFF;
+    for (uint8_t i = 0; i < 9; i++) {
+        scratchPad[i] = busRead();
+        ones &= scratchPad[i];
+        if (configured && i == CONFIGURATION && (scratchPad[i] == 0xFF || scratchPad[i] == 0x00)) {
+            return SCRATCHPAD_READ_ABSENT;
+        }
+    }
+    
+    if (ones == 0xFF || isAllZeros(scratchPad)) return SCRATCHPAD_READ_ABSENT;
+    if (_wire->crc8(scratchPad, 8) != scratchPad[SCRATCHPAD_CRC]) {
+#if REQUIRESBUSSTATS
+        busStats.crcErrors++;
+#endif
+        return SCRATCHPAD_READ_CRC_ERROR;
+    }
+    return SCRATCHPAD_READ_OK;
 }
 
 bool DallasTemperature::readPowerSupply(const uint8_t* deviceAddress) {
     bool parasiteMode = false;
-    _wire->reset();
+    busReset();
     if (deviceAddress == nullptr) {
-        _wire->skip();
+        busSkip();
     } else {
-        _wire->select(deviceAddress);
+        busSelect(deviceAddress);
     }
     
-    _wire->write(READPOWERSUPPLY);
+    busWrite(READPOWERSUPPLY);
     if (_wire->read_bit() == 0) {
         parasiteMode = true;
     }
-    _wire->reset();
+    busReset();
     return parasiteMode;
 }
 
@@ -204,152 +765,802 @@ bool DallasTemperature::isAllZeros(const uint8_t* const scratchPad, const size_t
 }
 
 bool DallasTemperature::readScratchPad(const uint8_t* deviceAddress, uint8_t* scratchPad) {
-    int b = _wire->reset();
+    if (!readScratchPadBytes(deviceAddress, scratchPad, 9)) return false;
+    
+    int b = busReset();
+    return (b == 1);
+}
+
+// Read the first length bytes of the scratchpad without the trailing
+// reset, the next transaction's reset ends the read
+bool DallasTemperature::readScratchPadBytes(const uint8_t* deviceAddress, uint8_t* scratchPad, uint8_t length) {
+    int b = busReset();
     if (b == 0) return false;
     
-    _wire->select(deviceAddress);
-    _wire->write(READSCRATCH);
+    busSelect(deviceAddress);
+    busWrite(READSCRATCH);
     
-    for (uint8_t i = 0; i < 9; i++) {
-        scratchPad[i] = _wire->read();
+    for (uint8_t i = 0; i < length; i++) {
+        scratchPad[i] = busRead();
     }
-    
-    b = _wire->reset();
-    return (b == 1);
+    return true;
 }
 
 void DallasTemperature::writeScratchPad(const uint8_t* deviceAddress, const uint8_t* scratchPad) {
-    _wire->reset();
-    _wire->select(deviceAddress);
-    _wire->write(WRITESCRATCH);
-    _wire->write(scratchPad[HIGH_ALARM_TEMP]); // high alarm temp
-    _wire->write(scratchPad[LOW_ALARM_TEMP]); // low alarm temp
+    sendScratchPad(deviceAddress, scratchPad);
+    
+    DeviceInfo* info = findDeviceInfo(deviceAddress);
+    if (info != nullptr && !info->dirty) updateShadow(info, scratchPad);
+    
+    if (autoSaveScratchPad) {
+        saveScratchPad(deviceAddress);
+    } else {
+        busReset();
+    }
+}
+
+// WRITESCRATCH without the trailing reset or EEPROM copy
+void DallasTemperature::sendScratchPad(const uint8_t* deviceAddress, const uint8_t* scratchPad) {
+    busReset();
+    busSelect(deviceAddress);
+    busWrite(WRITESCRATCH);
+    busWrite(scratchPad[HIGH_ALARM_TEMP]); // high alarm temp
+    busWrite(scratchPad[LOW_ALARM_TEMP]); // low alarm temp
     
     // DS1820 and DS18S20 have no configuration register
-    if (deviceAddress[0] != DS18S20MODEL) {
-        _wire->write(scratchPad[CONFIGURATION]);
+    if (!isFamily(deviceAddress, DS18S20MODEL)) {
+        busWrite(scratchPad[CONFIGURATION]);
+    }
+}
+
+// Table entry of an address. Sweeps look devices up in index order, so the
+// last entry found and the one after it are tried before the whole table,
+// which keeps a sweep over n devices linear instead of quadratic.
+DallasTemperature::DeviceInfo* DallasTemperature::findDeviceInfo(const uint8_t* deviceAddress) {
+    DeviceInfo* table = getDeviceTable();
+    for (DeviceIndex i = lookupHint; i < cachedDevices && i <= lookupHint + 1; i++) {
+        if (memcmp(table[i].address, deviceAddress, sizeof(DeviceAddress)) == 0) {
+            lookupHint = i;
+            return &table[i];
+        }
+    }
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        if (memcmp(table[i].address, deviceAddress, sizeof(DeviceAddress)) == 0) {
+            lookupHint = i;
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+// Scratchpad as it will be after commit(). A device with staged edits
+// is answered from RAM; only TH, TL and configuration are filled in.
+bool DallasTemperature::readStagedScratchPad(const uint8_t* deviceAddress, uint8_t* scratchPad) {
+    if (deferredWrites) {
+        DeviceInfo* info = findDeviceInfo(deviceAddress);
+        if (info != nullptr && info->dirty) {
+            memset(scratchPad, 0, sizeof(ScratchPad));
+            scratchPad[HIGH_ALARM_TEMP] = info->shadow[0];
+            scratchPad[LOW_ALARM_TEMP] = info->shadow[1];
+            scratchPad[CONFIGURATION] = info->shadow[2];
+            return true;
+        }
+    }
+    return isConnected(deviceAddress, scratchPad);
+}
+
+// Write a modified scratchpad, or stage it until commit() when writes are
+// deferred. Devices outside the address table are always written at once.
+void DallasTemperature::storeScratchPad(const uint8_t* deviceAddress, const uint8_t* scratchPad) {
+    if (deferredWrites) {
+        DeviceInfo* info = findDeviceInfo(deviceAddress);
+        if (info != nullptr) {
+            updateShadow(info, scratchPad);
+            info->dirty = true;
+            return;
+        }
+    }
+    writeScratchPad(deviceAddress, scratchPad);
+}
+
+// Stage scratchpad edits (alarms, resolution, user data) in RAM until
+// commit(). Turning it off commits anything still staged.
+void DallasTemperature::setDeferredWrites(bool flag) {
+    if (deferredWrites && !flag) commit();
+    deferredWrites = flag;
+}
+
+bool DallasTemperature::getDeferredWrites(void) {
+    return deferredWrites;
+}
+
+void DallasTemperature::updateShadow(DeviceInfo* info, const uint8_t* scratchPad) {
+    info->shadow[0] = scratchPad[HIGH_ALARM_TEMP];
+    info->shadow[1] = scratchPad[LOW_ALARM_TEMP];
+    info->shadow[2] = scratchPad[CONFIGURATION];
+    info->shadowValid = true;
+    if (validFamily(info->address)) {
+        info->resolution = decodeResolution(info->address, scratchPad);
+    }
+}
+
+// True when the address table holds every device on the bus, so a Skip ROM
+// command reaches no device outside it. A family search counts only
+// thermometers, so any other device it passed over rules this out.
+bool DallasTemperature::tableCoversBus(void) {
+    return cachedDevices == devices && !foreignDevices;
+}
+
+// True when every device on the bus is in the address table, takes the same
+// 3 byte WRITESCRATCH (DS18B20, DS1822, DS28EA00) and its shadow holds the
+// same TH and TL, and the configuration too if asked. scratchPad receives
+// the common bytes. DS18S20s lack the configuration byte and MAX31850s
+// share the DS1825 family code, so neither is ever broadcast to.
+bool DallasTemperature::uniformScratchPad(uint8_t* scratchPad, bool matchConfiguration) {
+    DeviceInfo* table = getDeviceTable();
+    if (cachedDevices == 0 || !tableCoversBus()) return false;
+    
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        const uint8_t* address = table[i].address;
+        if (!isFamily(address, DS18B20MODEL) && !isFamily(address, DS1822MODEL)
+            && !isFamily(address, DS28EA00MODEL)) return false;
+        if (!table[i].shadowValid) return false;
+        if (table[i].shadow[0] != table[0].shadow[0] || table[i].shadow[1] != table[0].shadow[1]) return false;
+        if (matchConfiguration && table[i].shadow[2] != table[0].shadow[2]) return false;
+    }
+    scratchPad[HIGH_ALARM_TEMP] = table[0].shadow[0];
+    scratchPad[LOW_ALARM_TEMP] = table[0].shadow[1];
+    scratchPad[CONFIGURATION] = table[0].shadow[2];
+    return true;
+}
+
+// Skip ROM WRITESCRATCH to every device, then one broadcast copy if
+// auto-save is on
+void DallasTemperature::broadcastScratchPad(const uint8_t* scratchPad) {
+    DeviceInfo* table = getDeviceTable();
+    
+    busReset();
+    busSkip();
+    busWrite(WRITESCRATCH);
+    busWrite(scratchPad[HIGH_ALARM_TEMP]);
+    busWrite(scratchPad[LOW_ALARM_TEMP]);
+    busWrite(scratchPad[CONFIGURATION]);
+    
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        updateShadow(&table[i], scratchPad);
+        table[i].dirty = false;
     }
     
     if (autoSaveScratchPad) {
-        saveScratchPad(deviceAddress);
+        saveScratchPad();
     } else {
-        _wire->reset();
+        busReset();
     }
 }
 
+// Write every device with staged edits once, then copy to EEPROM if
+// auto-save is on: one broadcast copy when every device on the bus
+// changed, otherwise one copy per written device. When every device was
+// given the same bytes the write is a single broadcast too. Returns the
+// number of devices written.
+DeviceIndex DallasTemperature::commit(void) {
+    DeviceInfo* table = getDeviceTable();
+    DeviceIndex written = 0;
+    bool everyDevice = tableCoversBus();
+    
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        if (!table[i].dirty) everyDevice = false;
+    }
+    
+    ScratchPad scratchPad;
+    if (everyDevice && uniformScratchPad(scratchPad, true)) {
+        broadcastScratchPad(scratchPad);
+        return cachedDevices;
+    }
+    
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        if (!table[i].dirty) continue;
+        
+        scratchPad[HIGH_ALARM_TEMP] = table[i].shadow[0];
+        scratchPad[LOW_ALARM_TEMP] = table[i].shadow[1];
+        scratchPad[CONFIGURATION] = table[i].shadow[2];
+        sendScratchPad(table[i].address, scratchPad);
+        if (autoSaveScratchPad && !everyDevice) {
+            saveScratchPad(table[i].address);
+        }
+        table[i].dirty = false;
+        written++;
+    }
+    
+    if (written > 0) {
+        if (!autoSaveScratchPad) {
+            busReset();
+        } else if (everyDevice) {
+            saveScratchPad();
+        }
+    }
+    return written;
+}
+
 bool DallasTemperature::saveScratchPad(const uint8_t* deviceAddress) {
-    if (_wire->reset() == 0) return false;
+#if REQUIRESEEPROMQUEUE
+    if (!waitForEeprom) return queueEeprom(deviceAddress, COPYSCRATCH);
+#endif
+    if (busReset() == 0) return false;
     
     if (deviceAddress == nullptr)
-        _wire->skip();
+        busSkip();
     else
-        _wire->select(deviceAddress);
+        busSelect(deviceAddress);
     
-    _wire->write(COPYSCRATCH, parasite);
+    busWrite(COPYSCRATCH, parasite);
     
     // Specification: NV Write Cycle Time is typically 2ms, max 10ms
     // Waiting 20ms to allow for sensors that take longer in practice
+#if REQUIRESBUSSTATS
+    unsigned long start = clockNow();
+#endif
     if (!parasite) {
-        delay(20);
+        clockWait(MAX_EEPROM_WRITE_TIME);
     } else {
         activateExternalPullup();
-        delay(20);
+        clockWait(MAX_EEPROM_WRITE_TIME);
         deactivateExternalPullup();
     }
+#if REQUIRESBUSSTATS
+    busStats.eepromWaitMillis += clockNow() - start;
+#endif
     
-    return (_wire->reset() == 1);
+    return (busReset() == 1);
+}
+
+bool DallasTemperature::saveScratchPadByIndex(DeviceIndex deviceIndex) {
+    DeviceAddress deviceAddress;
+    if (!getAddress(deviceAddress, deviceIndex)) return false;
+    return saveScratchPad(deviceAddress);
+}
+
+bool DallasTemperature::recallScratchPadByIndex(DeviceIndex deviceIndex) {
+    DeviceAddress deviceAddress;
+    if (!getAddress(deviceAddress, deviceIndex)) return false;
+    return recallScratchPad(deviceAddress);
 }
 
 bool DallasTemperature::recallScratchPad(const uint8_t* deviceAddress) {
-    if (_wire->reset() == 0) return false;
+#if REQUIRESEEPROMQUEUE
+    if (!waitForEeprom) return queueEeprom(deviceAddress, RECALLSCRATCH);
+#endif
+    if (busReset() == 0) return false;
+    
+    forgetShadow(deviceAddress);
+    if (deviceAddress == nullptr)
+        busSkip();
+    else
+        busSelect(deviceAddress);
+    
+    busWrite(RECALLSCRATCH, parasite);
+    
+    // Specification: Strong pullup only needed when writing to EEPROM
+    unsigned long start = clockNow();
+    while (_wire->read_bit() == 0) {
+        if (clockNow() - start > MAX_EEPROM_WRITE_TIME) return false;
+        clockIdle();
+    }
+    
+    return (busReset() == 1);
+}
+
+// The scratchpad is reloaded from EEPROM, staged edits are lost
+void DallasTemperature::forgetShadow(const uint8_t* deviceAddress) {
+    DeviceInfo* table = getDeviceTable();
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        if (deviceAddress == nullptr || memcmp(table[i].address, deviceAddress, sizeof(DeviceAddress)) == 0) {
+            table[i].shadowValid = false;
+            table[i].dirty = false;
+        }
+    }
+}
+
+#if REQUIRESEEPROMQUEUE
+// Without waiting for the EEPROM, saveScratchPad() and recallScratchPad(),
+// and the automatic save after a write, queue the operation and return at
+// once. tick() then runs the queue one operation at a time and passes each
+// result to the EEPROM handler. On parasite power the copy draws its
+// current from the strong pullup, so any other bus call made while one
+// runs first waits for it to finish.
+void DallasTemperature::setWaitForEeprom(bool flag) {
+    waitForEeprom = flag;
+}
+
+bool DallasTemperature::getWaitForEeprom(void) {
+    return waitForEeprom;
+}
+
+// Queued EEPROM operations, the running one included
+uint8_t DallasTemperature::getPendingEeprom(void) {
+    return eepromCount;
+}
+
+void DallasTemperature::setEepromHandler(EepromHandler* handler) {
+    _EepromHandler = handler;
+}
+
+// Queue a copy or recall; one already waiting for the same devices is not
+// repeated. A full queue is not waited for: the operation is dropped, and
+// false returned and passed to the EEPROM handler.
+bool DallasTemperature::queueEeprom(const uint8_t* deviceAddress, uint8_t command) {
+    for (uint8_t i = eepromRunning ? 1 : 0; i < eepromCount; i++) {
+        const EepromOperation& op = eepromQueue[(eepromHead + i) % EEPROM_QUEUE_SIZE];
+        if (op.command != command) continue;
+        if (deviceAddress == nullptr ? op.all
+                                     : !op.all && memcmp(op.address, deviceAddress, sizeof(DeviceAddress)) == 0)
+            return true;
+    }
+    
+    EepromOperation op;
+    op.all = (deviceAddress == nullptr);
+    if (!op.all) memcpy(op.address, deviceAddress, sizeof(DeviceAddress));
+    op.command = command;
+    if (eepromCount == EEPROM_QUEUE_SIZE) {
+        reportEeprom(op, false);
+        return false;
+    }
+    
+    eepromQueue[(eepromHead + eepromCount) % EEPROM_QUEUE_SIZE] = op;
+    eepromCount++;
+    return true;
+}
+
+// One step of the EEPROM queue: start the oldest operation, or finish the
+// running one. Devices answer read slots with 0 until a recall, or an
+// externally powered copy, is done, which ends the wait early while
+// nothing else used the bus; otherwise MAX_EEPROM_WRITE_TIME is waited.
+void DallasTemperature::serviceEeprom(void) {
+    if (eepromCount == 0) return;
+    EepromOperation& op = eepromQueue[eepromHead];
+    
+    if (!eepromRunning) {
+        if (op.command == RECALLSCRATCH) forgetShadow(op.all ? nullptr : op.address);
+        if (busReset() == 0) {
+            finishEeprom(false);
+            return;
+        }
+        if (op.all)
+            busSkip();
+        else
+            busSelect(op.address);
+        busWrite(op.command, parasite && op.command == COPYSCRATCH);
+        if (parasite && op.command == COPYSCRATCH) activateExternalPullup();
+        eepromStart = clockNow();
+        eepromRunning = true;
+        eepromPolled = true;
+        return;
+    }
+    
+    bool done = (clockNow() - eepromStart) >= MAX_EEPROM_WRITE_TIME;
+    bool polls = !parasite || op.command == RECALLSCRATCH;
+    if (!done && polls && eepromPolled) done = (_wire->read_bit() == 1);
+    if (!done) return;
+    
+    deactivateExternalPullup();
+    eepromRunning = false;
+    finishEeprom(busReset() == 1);
+}
+
+// Drop the oldest operation and report it
+void DallasTemperature::finishEeprom(bool ok) {
+    EepromOperation op = eepromQueue[eepromHead];
+    eepromHead = (eepromHead + 1) % EEPROM_QUEUE_SIZE;
+    eepromCount--;
+    eepromRunning = false;
+    reportEeprom(op, ok);
+}
+
+// Pass an operation's result to the EEPROM handler per device; a Skip ROM
+// one is reported for every thermometer of the address table
+void DallasTemperature::reportEeprom(const EepromOperation& op, bool ok) {
+    if (_EepromHandler == nullptr) return;
+    if (!op.all) {
+        _EepromHandler(op.address, ok);
+        return;
+    }
+    DeviceInfo* table = getDeviceTable();
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        if (validFamily(table[i].address)) _EepromHandler(table[i].address, ok);
+    }
+}
+#endif
+
+// Read only TEMP_LSB and TEMP_MSB, ending the read with a reset. Without
+// a CRC the value is checked for plausibility instead: the bus floating
+// high (0xFFFF), the 85 C power-on value, inconsistent sign bits and
+// anything outside -55..125 C are rejected. DS18S20s need COUNT_REMAIN and
+// family 0x3B the configuration byte, so they are never read this way.
+uint8_t DallasTemperature::readTemperatureFast(const uint8_t* deviceAddress, int32_t* raw) {
+    if (isFamily(deviceAddress, DS18S20MODEL) || isFamily(deviceAddress, DS1825MODEL))
+        return SCRATCHPAD_READ_UNSUPPORTED;
+    
+    ScratchPad scratchPad;
+    if (!readScratchPadBytes(deviceAddress, scratchPad, 2)) return SCRATCHPAD_READ_ABSENT;
+    busReset();
+    
+    int16_t value = (int16_t)((scratchPad[TEMP_MSB] << 8) | scratchPad[TEMP_LSB]);
+    uint8_t sign = scratchPad[TEMP_MSB] & 0xF8;
+    if (value == -1 || value == 0x0550 || (sign != 0 && sign != 0xF8)
+        || value < -55 * 16 || value > 125 * 16) {
+        return SCRATCHPAD_READ_IMPLAUSIBLE;
+    }
+    
+    *raw = calculateTemperature(deviceAddress, scratchPad);
+    return SCRATCHPAD_READ_OK;
+}
+
+void DallasTemperature::setReadMode(read_mode_t mode) {
+    readMode = mode;
+}
+
+DallasTemperature::read_mode_t DallasTemperature::getReadMode(void) {
+    return readMode;
+}
+
+// A quarantined device is still read, and its health recorded
+int32_t DallasTemperature::getTemp(const uint8_t* deviceAddress, byte retryCount) {
+    return readTemp(deviceAddress, retryCount, false);
+}
+
+// getTemp(), skipping a quarantined device when quarantine is set, as the
+// conversion engine does
+int32_t DallasTemperature::readTemp(const uint8_t* deviceAddress, byte retryCount, bool quarantine) {
+    int32_t raw = DEVICE_DISCONNECTED_RAW;
+    DeviceInfo* info = (REQUIRESHEALTH || readingTable != nullptr) ? findDeviceInfo(deviceAddress) : nullptr;
+    Reading reading = { raw, 0, READING_QUARANTINED, false };
+#if REQUIRESHEALTH
+    if (quarantine && info != nullptr && !admitRead(info)) {
+        reading.timestamp = clockNow();
+        storeReading(info, reading);
+        return raw;
+    }
+    if (info != nullptr) budgetRetries(info, &retryCount);
+#else
+    (void)quarantine;
+#endif
+    uint8_t result = readTemperature(deviceAddress, retryCount, &raw, info, &reading.crcOk);
+#if REQUIRESHEALTH
+    if (info != nullptr) recordRead(info, result == SCRATCHPAD_READ_OK, raw);
+#endif
+    if (info != nullptr && readingTable != nullptr) {
+        reading.raw = raw;
+        reading.timestamp = clockNow();
+        if (result == SCRATCHPAD_READ_OK) {
+            reading.status = (raw < DEVICE_DISCONNECTED_RAW) ? READING_FAULT : READING_OK;
+        } else {
+            reading.status = (result == SCRATCHPAD_READ_CRC_ERROR) ? READING_CRC_ERROR : READING_DISCONNECTED;
+        }
+        storeReading(info, reading);
+    }
+    return raw;
+}
+
+// The bus side of getTemp(). info, when given, collects CRC statistics;
+// crcOk is set when the value came from a CRC checked scratchpad.
+uint8_t DallasTemperature::readTemperature(const uint8_t* deviceAddress, byte retryCount, int32_t* raw, DeviceInfo* info, bool* crcOk) {
+    ScratchPad scratchPad;
+    byte retries = 0;
+    uint8_t result = SCRATCHPAD_READ_ABSENT;
+    
+    if (readMode != READ_FULL) {
+        result = readTemperatureFast(deviceAddress, raw);
+        if (result == SCRATCHPAD_READ_OK || result == SCRATCHPAD_READ_ABSENT) return result;
+        if (result == SCRATCHPAD_READ_IMPLAUSIBLE && readMode == READ_FAST_ONLY) return result;
+    }
+    
+    while (retries++ <= retryCount) {
+#if REQUIRESBUSSTATS
+        if (retries > 1) busStats.retries++;
+#endif
+        result = readScratchPadChecked(deviceAddress, scratchPad);
+#if REQUIRESHEALTH
+        if (info != nullptr) recordAttempt(info, result);
+#endif
+        // a device that is not there will not answer a retry either
+        if (result == SCRATCHPAD_READ_ABSENT) break;
+        
+        busReset();
+        if (result == SCRATCHPAD_READ_OK) {
+            *raw = calculateTemperature(deviceAddress, scratchPad);
+            fillResolution(info, scratchPad);
+            *crcOk = true;
+            break;
+        }
+    }
+    return result;
+}
+
+#if REQUIRESHEALTH
+
+// Quarantined devices are skipped until their next probe
+bool DallasTemperature::admitRead(DeviceInfo* info) {
+    if (quarantineThreshold == 0) return true;
+    DeviceHealth& health = info->health;
+    if (health.skip > 0) {
+        health.skip--;
+        return false;
+    }
+    return true;
+}
+
+// Retries asked of getTemp(), cut to what the device's record justifies.
+// A single failed read may be a glitch, after that the budget halves with
+// every consecutive failure so a dead sensor stops costing retries. A
+// sensor failing its CRC on more than CRC_RETRY_PERCENT of recent reads
+// is not helped by many retries either and gets one at most.
+void DallasTemperature::budgetRetries(const DeviceInfo* info, byte* retryCount) {
+    const DeviceHealth& health = info->health;
+    if (health.failures > 1) {
+        *retryCount = (health.failures < 9) ? (*retryCount >> (health.failures - 1)) : 0;
+    }
+    if (health.reads >= 8 && (uint16_t)health.crcErrors * 100 > (uint16_t)health.reads * CRC_RETRY_PERCENT
+        && *retryCount > 1) {
+        *retryCount = 1;
+    }
+}
+
+// CRC error rate over roughly the last 128 to 255 attempts
+void DallasTemperature::recordAttempt(DeviceInfo* info, uint8_t result) {
+    DeviceHealth& health = info->health;
+    if (++health.reads == 0xFF) {
+        health.reads >>= 1;
+        health.crcErrors >>= 1;
+    }
+    if (result == SCRATCHPAD_READ_CRC_ERROR) health.crcErrors++;
+}
+
+void DallasTemperature::recordRead(DeviceInfo* info, bool ok, int32_t raw) {
+    DeviceHealth& health = info->health;
+    if (ok) {
+        health.failures = 0;
+        health.backoff = 0;
+        health.lastRaw = raw;
+        health.lastGood = clockNow();
+        return;
+    }
+    
+    if (health.failures < 0xFF) health.failures++;
+    if (quarantineThreshold > 0 && health.failures >= quarantineThreshold) {
+        // every failed probe doubles the time to the next one
+        if (health.backoff < QUARANTINE_MAX_BACKOFF) health.backoff++;
+        health.skip = (1 << health.backoff) - 1;
+    }
+}
+
+// Consecutive failed reads before a device is quarantined; 0, the
+// default, never quarantines. getReading(), readAll() and tick() skip a
+// quarantined device, getTemp() and the getTempC() family still read it.
+void DallasTemperature::setQuarantineThreshold(uint8_t failures) {
+    quarantineThreshold = failures;
+}
+
+bool DallasTemperature::isQuarantined(const uint8_t* deviceAddress) {
+    DeviceInfo* info = findDeviceInfo(deviceAddress);
+    return info != nullptr && info->health.backoff > 0;
+}
+
+// Forget the health of every device, e.g. after fixing the wiring
+void DallasTemperature::resetHealth(void) {
+    DeviceInfo* table = getDeviceTable();
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        memset(&table[i].health, 0, sizeof(DeviceHealth));
+    }
+}
+
+#endif
+
+#if REQUIRESFLOAT
+
+float DallasTemperature::getTempC(const uint8_t* deviceAddress, byte retryCount) {
+    return rawToCelsius(getTemp(deviceAddress, retryCount));
+}
+
+float DallasTemperature::getTempF(const uint8_t* deviceAddress) {
+    return rawToFahrenheit(getTemp(deviceAddress));
+}
+
+float DallasTemperature::getTempCByIndex(DeviceIndex index) {
+    DeviceAddress deviceAddress;
+    if (!getAddress(deviceAddress, index)) {
+        return DEVICE_DISCONNECTED_C;
+    }
+    return getTempC((uint8_t*)deviceAddress);
+}
+
+float DallasTemperature::getTempFByIndex(DeviceIndex index) {
+    DeviceAddress deviceAddress;
+    if (!getAddress(deviceAddress, index)) {
+        return DEVICE_DISCONNECTED_F;
+    }
+    return getTempF((uint8_t*)deviceAddress);
+}
+
+#endif
+
+// Integer counterparts of getTempC() and getTempF(), in thousandths of a
+// degree, for builds that avoid floating point
+int32_t DallasTemperature::getTempMilliC(const uint8_t* deviceAddress, byte retryCount) {
+    return rawToMilliCelsius(getTemp(deviceAddress, retryCount));
+}
+
+int32_t DallasTemperature::getTempMilliF(const uint8_t* deviceAddress) {
+    return rawToMilliFahrenheit(getTemp(deviceAddress));
+}
+
+int32_t DallasTemperature::getTempMilliCByIndex(DeviceIndex index) {
+    DeviceAddress deviceAddress;
+    if (!getAddress(deviceAddress, index)) {
+        return DEVICE_DISCONNECTED_MILLIC;
+    }
+    return getTempMilliC(deviceAddress);
+}
+
+int32_t DallasTemperature::getTempMilliFByIndex(DeviceIndex index) {
+    DeviceAddress deviceAddress;
+    if (!getAddress(deviceAddress, index)) {
+        return DEVICE_DISCONNECTED_MILLIF;
+    }
+    return getTempMilliF(deviceAddress);
+}
+
+// Read one sensor into a Reading. Unlike getTemp() the read is not
+// followed by a reset, so back-to-back reads cost one reset each.
+bool DallasTemperature::getReading(const uint8_t* deviceAddress, Reading* reading) {
+    DeviceInfo* info = (REQUIRESHEALTH || readingTable != nullptr) ? findDeviceInfo(deviceAddress) : nullptr;
+    bool ok = readReading(deviceAddress, reading, info);
+    if (info != nullptr) storeReading(info, *reading);
+    return ok;
+}
+
+bool DallasTemperature::readReading(const uint8_t* deviceAddress, Reading* reading, DeviceInfo* info) {
+    ScratchPad scratchPad;
     
-    if (deviceAddress == nullptr)
-        _wire->skip();
-    else
-        _wire->select(deviceAddress);
+    reading->raw = DEVICE_DISCONNECTED_RAW;
+    reading->crcOk = false;
     
-    _wire->write(RECALLSCRATCH, parasite);
+    if (!validFamily(deviceAddress)) {
+        reading->status = READING_UNSUPPORTED;
+        reading->timestamp = clockNow();
+        return false;
+    }
     
-    // Specification: Strong pullup only needed when writing to EEPROM
-    unsigned long start = millis();
-    while (_wire->read_bit() == 0) {
-        if (millis() - start > 20) return false;
-        yield();
+#if REQUIRESHEALTH
+    if (info != nullptr && !admitRead(info)) {
+        reading->status = READING_QUARANTINED;
+        reading->timestamp = clockNow();
+        return false;
     }
+#endif
     
-    return (_wire->reset() == 1);
-}
-
-int32_t DallasTemperature::getTemp(const uint8_t* deviceAddress, byte retryCount) {
-    ScratchPad scratchPad;
-    byte retries = 0;
+    uint8_t result = SCRATCHPAD_READ_UNSUPPORTED;
+    if (readMode != READ_FULL) {
+        result = readTemperatureFast(deviceAddress, &reading->raw);
+    }
     
-    while (retries++ <= retryCount) {
-        if (isConnected(deviceAddress, scratchPad)) {
-            return calculateTemperature(deviceAddress, scratchPad);
+    bool fault = false;
+    if (result == SCRATCHPAD_READ_UNSUPPORTED || (result == SCRATCHPAD_READ_IMPLAUSIBLE && readMode == READ_FAST)) {
+        result = readScratchPadChecked(deviceAddress, scratchPad);
+#if REQUIRESHEALTH
+        if (info != nullptr) recordAttempt(info, result);
+#endif
+        if (result == SCRATCHPAD_READ_OK) {
+            reading->crcOk = true;
+            reading->raw = calculateTemperature(deviceAddress, scratchPad);
+            fillResolution(info, scratchPad);
+            fault = isFamily(deviceAddress, DS1825MODEL) && (scratchPad[CONFIGURATION] & 0x80)
+                    && (scratchPad[TEMP_LSB] & 1);
         }
     }
+    reading->timestamp = clockNow();
     
-    return DEVICE_DISCONNECTED_RAW;
+    if (result == SCRATCHPAD_READ_OK) {
+        reading->status = fault ? READING_FAULT : READING_OK;
+    } else if (result == SCRATCHPAD_READ_CRC_ERROR) {
+        reading->status = READING_CRC_ERROR;
+    } else {
+        reading->status = READING_DISCONNECTED;
+    }
+#if REQUIRESHEALTH
+    if (info != nullptr) recordRead(info, result == SCRATCHPAD_READ_OK, reading->raw);
+#endif
+    return reading->status == READING_OK;
 }
 
-float DallasTemperature::getTempC(const uint8_t* deviceAddress, byte retryCount) {
-    return rawToCelsius(getTemp(deviceAddress, retryCount));
+// Keep a reading of a table device, when a DeviceTable holds readings
+void DallasTemperature::storeReading(DeviceInfo* info, const Reading& reading) {
+    if (readingTable != nullptr) readingTable[info - getDeviceTable()] = reading;
 }
 
-float DallasTemperature::getTempF(const uint8_t* deviceAddress) {
-    return rawToFahrenheit(getTemp(deviceAddress));
+// The last result read from a device of a DeviceTable, by getTemp(),
+// getReading(), readAll() or the conversion engine. nullptr when the
+// table holds no readings or the index is outside it.
+const DallasTemperature::Reading* DallasTemperature::getLatestReading(DeviceIndex index) {
+    if (readingTable == nullptr || index >= cachedDevices) return nullptr;
+    return &readingTable[index];
 }
 
-float DallasTemperature::getTempCByIndex(uint8_t index) {
+bool DallasTemperature::getReadingByIndex(DeviceIndex index, Reading* reading) {
     DeviceAddress deviceAddress;
     if (!getAddress(deviceAddress, index)) {
-        return DEVICE_DISCONNECTED_C;
+        reading->raw = DEVICE_DISCONNECTED_RAW;
+        reading->timestamp = clockNow();
+        reading->status = READING_DISCONNECTED;
+        reading->crcOk = false;
+        return false;
     }
-    return getTempC((uint8_t*)deviceAddress);
+    return getReading(deviceAddress, reading);
 }
 
-float DallasTemperature::getTempFByIndex(uint8_t index) {
-    DeviceAddress deviceAddress;
-    if (!getAddress(deviceAddress, index)) {
-        return DEVICE_DISCONNECTED_F;
+// Read every device, in index order, into readings[0..count-1] in a single
+// pass. Returns the number of entries filled.
+DeviceIndex DallasTemperature::readAll(Reading* readings, size_t count) {
+    DeviceInfo* table = getDeviceTable();
+    DeviceIndex index = 0;
+    
+    if (count > devices) count = devices;
+    
+    for (; index < count && index < cachedDevices; index++) {
+        getReading(table[index].address, &readings[index]);
     }
-    return getTempF((uint8_t*)deviceAddress);
+    
+    if (index < count) {
+        // devices past the table: one search walk rather than one per index
+        DeviceAddress deviceAddress;
+        DeviceIndex found = 0;
+        resetSearch();
+        while (index < count && searchNext(deviceAddress)) {
+            if (!validAddress(deviceAddress)) continue;
+            if (found++ < index) continue;
+            getReading(deviceAddress, &readings[index++]);
+        }
+    }
+    return index;
 }
 
 void DallasTemperature::setResolution(uint8_t newResolution) {
     bitResolution = constrain(newResolution, 9, 12);
+    
+    // same alarm bytes everywhere: one Skip ROM write configures the bus
+    ScratchPad scratchPad;
+    if (!deferredWrites && uniformScratchPad(scratchPad, false)) {
+        scratchPad[CONFIGURATION] = configurationFor(bitResolution);
+        broadcastScratchPad(scratchPad);
+        return;
+    }
+    
     DeviceAddress deviceAddress;
-    _wire->reset_search();
-    for (uint8_t i = 0; i < devices; i++) {
-        if (_wire->search(deviceAddress) && validAddress(deviceAddress)) {
+    resetSearch();
+    for (DeviceIndex i = 0; i < devices; i++) {
+        if (searchNext(deviceAddress) && validAddress(deviceAddress)) {
             setResolution(deviceAddress, bitResolution, true);
         }
     }
+    
+    // DS18S20s keep their fixed 750 ms conversion
+    if (cachedDevices == devices) updateBitResolution();
 }
 
 bool DallasTemperature::setResolution(const uint8_t* deviceAddress, uint8_t newResolution, bool skipGlobalBitResolutionCalculation) {
     bool success = false;
     
-    if (deviceAddress[0] == DS18S20MODEL) {
+    if (isFamily(deviceAddress, DS18S20MODEL)) {
         success = true;
     } else {
         newResolution = constrain(newResolution, 9, 12);
-        uint8_t newValue = 0;
+        uint8_t newValue;
         ScratchPad scratchPad;
         
-        if (isConnected(deviceAddress, scratchPad)) {
-            switch (newResolution) {
-                case 12: newValue = TEMP_12_BIT; break;
-                case 11: newValue = TEMP_11_BIT; break;
-                case 10: newValue = TEMP_10_BIT; break;
-                case 9:
-                default: newValue = TEMP_9_BIT; break;
-            }
-            
+        if (readStagedScratchPad(deviceAddress, scratchPad)) {
+            newValue = configurationFor(newResolution);
             if (scratchPad[CONFIGURATION] != newValue) {
                 scratchPad[CONFIGURATION] = newValue;
-                writeScratchPad(deviceAddress, scratchPad);
+                storeScratchPad(deviceAddress, scratchPad);
             }
             success = true;
         }
@@ -357,12 +1568,14 @@ bool DallasTemperature::setResolution(const uint8_t* deviceAddress, uint8_t newR
     
     if (!skipGlobalBitResolutionCalculation && success) {
         bitResolution = newResolution;
-        if (devices > 1) {
+        if (cachedDevices == devices) {
+            updateBitResolution();
+        } else if (devices > 1) {
             DeviceAddress deviceAddr;
-            _wire->reset_search();
-            for (uint8_t i = 0; i < devices; i++) {
+            resetSearch();
+            for (DeviceIndex i = 0; i < devices; i++) {
                 if (bitResolution == 12) break;
-                if (_wire->search(deviceAddr) && validAddress(deviceAddr)) {
+                if (searchNext(deviceAddr) && validAddress(deviceAddr)) {
                     uint8_t b = getResolution(deviceAddr);
                     if (b > bitResolution) bitResolution = b;
                 }
@@ -377,24 +1590,76 @@ uint8_t DallasTemperature::getResolution() {
 }
 
 uint8_t DallasTemperature::getResolution(const uint8_t* deviceAddress) {
-    if (deviceAddress[0] == DS18S20MODEL) return 12;
+    if (isFamily(deviceAddress, DS18S20MODEL)) return 12;
     
     ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad)) {
-        if (deviceAddress[0] == DS1825MODEL && scratchPad[CONFIGURATION] & 0x80) {
-            return 12;
-        }
-        
-        switch (scratchPad[CONFIGURATION]) {
-            case TEMP_12_BIT: return 12;
-            case TEMP_11_BIT: return 11;
-            case TEMP_10_BIT: return 10;
-            case TEMP_9_BIT: return 9;
-        }
+    if (readStagedScratchPad(deviceAddress, scratchPad)) {
+        return decodeResolution(deviceAddress, scratchPad);
+    }
+    return 0;
+}
+
+// bitResolution is the slowest device in the address table
+void DallasTemperature::updateBitResolution(void) {
+    DeviceInfo* table = getDeviceTable();
+    bitResolution = 9;
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        if (waitResolution(&table[i]) > bitResolution) bitResolution = waitResolution(&table[i]);
+    }
+}
+
+// Resolution to wait for: a thermometer whose resolution is not known
+// yet counts as the slowest
+uint8_t DallasTemperature::waitResolution(const DeviceInfo* info) {
+    if (info->resolution == 0 && validFamily(info->address)) return 12;
+    return info->resolution;
+}
+
+// A good scratchpad read of a table device whose resolution begin() could
+// not read
+void DallasTemperature::fillResolution(DeviceInfo* info, const uint8_t* scratchPad) {
+    if (info != nullptr && info->resolution == 0 && validFamily(info->address)) {
+        info->resolution = decodeResolution(info->address, scratchPad);
+    }
+}
+
+// Resolution of a table device, read from the device when begin() could
+// not read its scratchpad. 0 for other devices and ones still not answering.
+uint8_t DallasTemperature::deviceResolution(DeviceInfo* info) {
+    if (info->resolution == 0 && validFamily(info->address)) {
+        info->resolution = getResolution(info->address);
+        if (info->resolution != 0 && cachedDevices == devices) updateBitResolution();
+    }
+    return info->resolution;
+}
+
+uint8_t DallasTemperature::decodeResolution(const uint8_t* deviceAddress, const uint8_t* scratchPad) {
+    if (isFamily(deviceAddress, DS18S20MODEL)) return 12;
+    if (isFamily(deviceAddress, DS1825MODEL) && scratchPad[CONFIGURATION] & 0x80) {
+        return 12;
+    }
+    
+    switch (scratchPad[CONFIGURATION]) {
+        case TEMP_12_BIT: return 12;
+        case TEMP_11_BIT: return 11;
+        case TEMP_10_BIT: return 10;
+        case TEMP_9_BIT: return 9;
     }
     return 0;
 }
 
+uint8_t DallasTemperature::configurationFor(uint8_t resolution) {
+    switch (resolution) {
+        case 12: return TEMP_12_BIT;
+        case 11: return TEMP_11_BIT;
+        case 10: return TEMP_10_BIT;
+        case 9:
+        default: return TEMP_9_BIT;
+    }
+}
+
+#if REQUIRESFLOAT
+
 float DallasTemperature::toFahrenheit(float celsius) {
     return (celsius * 1.8f) + 32.0f;
 }
@@ -419,6 +1684,8 @@ int16_t DallasTemperature::celsiusToRaw(float celsius) {
     return static_cast<int16_t>(celsius * 128.0f);
 }
 
+#endif
+
 uint16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution) {
     switch (bitResolution) {
         case 9:  return 94;
@@ -428,8 +1695,74 @@ uint16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution) {
     }
 }
 
+// Wait for a conversion at the current resolution, learned when possible
 uint16_t DallasTemperature::millisToWaitForConversion() {
-    return millisToWaitForConversion(bitResolution);
+    return conversionWait(bitResolution);
+}
+
+// Measure Skip ROM conversions on externally powered buses and wait for
+// the slowest one seen, plus CONVERSION_MARGIN_PERCENT, wherever completion cannot be
+// polled: checkForConversion off, and the conversion engine once it has
+// used the bus. Parasite devices cannot be polled, so nothing is learned
+// there and they keep the datasheet times.
+void DallasTemperature::setLearnConversionTime(bool flag) {
+    learnConversionTime = flag;
+}
+
+bool DallasTemperature::getLearnConversionTime(void) {
+    return learnConversionTime;
+}
+
+// Datasheet time scaled by the learned speed of this bus. Every
+// resolution shares the scale, conversion time doubling with each bit.
+uint16_t DallasTemperature::conversionWait(uint8_t resolution) {
+    uint16_t limit = millisToWaitForConversion(resolution);
+    if (!learnConversionTime || conversionScale == 0) return limit;
+    
+    uint32_t wait = (uint32_t)limit * conversionScale * (100 + CONVERSION_MARGIN_PERCENT) / 25600 + 1;
+    return (wait < limit) ? wait : limit;
+}
+
+// Slower samples count at once, faster ones pull the estimate down slowly.
+// Only a Skip ROM conversion times the slowest device of the bus; a single
+// device's may raise an estimate but neither set nor lower it, or a fast
+// device polled on its own would cut the wait short for the slow ones.
+void DallasTemperature::learnConversion(uint8_t resolution, unsigned long elapsed, bool broadcast) {
+    uint16_t limit = millisToWaitForConversion(resolution);
+    uint16_t sample = (elapsed >= limit) ? 256 : (uint16_t)((elapsed * 256 + limit - 1) / limit);
+    
+    if (!broadcast) {
+        if (conversionScale != 0 && sample > conversionScale) conversionScale = sample;
+    } else if (sample >= conversionScale) {
+        conversionScale = sample;
+    } else {
+        conversionScale -= (conversionScale - sample + 7) / 8;
+    }
+}
+
+void DallasTemperature::startPolling(uint8_t resolution, unsigned long start, bool broadcast) {
+    pollResolution = resolution;
+    pollStart = start;
+    pollBusy = false;
+    pollBroadcast = broadcast;
+}
+
+// Status poll of the conversion started at start. Finding it done shortly
+// after a poll that saw it running measures its duration.
+bool DallasTemperature::pollConversion(unsigned long start) {
+    unsigned long elapsed = clockNow() - start;
+    if (!isConversionComplete()) {
+        if (start == pollStart) {
+            pollBusy = true;
+            pollBusyAt = elapsed;
+        }
+        return false;
+    }
+    if (start == pollStart && pollBusy && elapsed - pollBusyAt <= elapsed / 32 + 1) {
+        learnConversion(pollResolution, elapsed, pollBroadcast);
+    }
+    if (start == pollStart) pollBusy = false;
+    return true;
 }
 
 void DallasTemperature::setWaitForConversion(bool flag) {
@@ -453,6 +1786,19 @@ bool DallasTemperature::isConversionComplete() {
     return (b == 1);
 }
 
+// Non-blocking counterpart of blockTillConversionComplete(): polls the bus
+// when the devices can report it, otherwise compares the elapsed time.
+// Polling only works if the bus was left alone since the request.
+bool DallasTemperature::isConversionComplete(request_t req) {
+    if (!req.result) return true;
+    
+    unsigned long elapsed = clockNow() - req.timestamp;
+    if (checkForConversion && !parasite) {
+        return (elapsed >= (unsigned long)MAX_CONVERSION_TIMEOUT) || pollConversion(req.timestamp);
+    }
+    return elapsed >= conversionWait(req.timestamp == pollStart ? pollResolution : bitResolution);
+}
+
 void DallasTemperature::setAutoSaveScratchPad(bool flag) {
     autoSaveScratchPad = flag;
 }
@@ -465,11 +1811,12 @@ DallasTemperature::request_t DallasTemperature::requestTemperatures() {
     request_t req = {};
     req.result = true;
     
-    _wire->reset();
-    _wire->skip();
-    _wire->write(STARTCONVO, parasite);
+    busReset();
+    busSkip();
+    busWrite(STARTCONVO, parasite);
     
-    req.timestamp = millis();
+    req.timestamp = clockNow();
+    startPolling(bitResolution, req.timestamp, true);
     if (!waitForConversion) return req;
     
     blockTillConversionComplete(bitResolution, req.timestamp);
@@ -478,18 +1825,21 @@ DallasTemperature::request_t DallasTemperature::requestTemperatures() {
 
 DallasTemperature::request_t DallasTemperature::requestTemperaturesByAddress(const uint8_t* deviceAddress) {
     request_t req = {};
-    uint8_t deviceBitResolution = getResolution(deviceAddress);
-    if (deviceBitResolution == 0) {
+    
+    // the table knows the resolution, anything else costs a scratchpad read
+    DeviceInfo* info = findDeviceInfo(deviceAddress);
+    uint8_t deviceBitResolution = (info != nullptr) ? deviceResolution(info) : getResolution(deviceAddress);
+    if (deviceBitResolution == 0 || busReset() == 0) {
         req.result = false;
         return req;
     }
     
-    _wire->reset();
-    _wire->select(deviceAddress);
-    _wire->write(STARTCONVO, parasite);
+    busSelect(deviceAddress);
+    busWrite(STARTCONVO, parasite);
     
-    req.timestamp = millis();
+    req.timestamp = clockNow();
     req.result = true;
+    startPolling(deviceBitResolution, req.timestamp, false);
     
     if (!waitForConversion) return req;
     
@@ -497,28 +1847,398 @@ DallasTemperature::request_t DallasTemperature::requestTemperaturesByAddress(con
     return req;
 }
 
-DallasTemperature::request_t DallasTemperature::requestTemperaturesByIndex(uint8_t index) {
+DallasTemperature::request_t DallasTemperature::requestTemperaturesByIndex(DeviceIndex index) {
     DeviceAddress deviceAddress;
-    getAddress(deviceAddress, index);
+    if (!getAddress(deviceAddress, index)) {
+        request_t req = {};
+        req.result = false;
+        return req;
+    }
     return requestTemperaturesByAddress(deviceAddress);
 }
 
+// Start a conversion on all devices without waiting for it. Call tick()
+// from the main loop until it returns CONVERSION_READY; each reading is
+// passed to the temperature handler as soon as it has been read.
+bool DallasTemperature::startConversion(void) {
+    if (conversionState != CONVERSION_IDLE && conversionState != CONVERSION_READY)
+        return false;
+    
+    if (busReset() == 0) return false;
+    busSkip();
+    busWrite(STARTCONVO, parasite);
+    // powered devices are polled and read while converting, which the
+    // strong pullup would short; parasite ones are left alone
+    if (parasite) activateExternalPullup();
+    
+    conversionRequest.result = true;
+    conversionRequest.timestamp = clockNow();
+    startPolling(bitResolution, conversionRequest.timestamp, true);
+    conversionIndex = 0;
+    conversionTier = 9;
+    conversionPolled = true;
+    conversionState = CONVERSION_CONVERTING;
+    return true;
+}
+
+// End a sweep of startConversion() without reading the devices left, e.g.
+// when they are read by other means. A parasite bus loses its strong
+// pullup, so stop only once the conversion time has passed.
+void DallasTemperature::stopConversion(void) {
+    if (conversionState != CONVERSION_CONVERTING && conversionState != CONVERSION_READING) return;
+    deactivateExternalPullup();
+    conversionState = CONVERSION_IDLE;
+}
+
+// Read the next table device whose resolution is at most maxResolution,
+// fastest devices first. Returns false once there are none left.
+bool DallasTemperature::readNextConverted(uint8_t maxResolution) {
+    DeviceInfo* table = getDeviceTable();
+    
+    while (conversionTier <= maxResolution) {
+        while (conversionIndex < cachedDevices) {
+            DeviceIndex index = conversionIndex++;
+            // devices that are not thermometers cost no bus time
+            if (!validFamily(table[index].address)) continue;
+            
+            uint8_t resolution = waitResolution(&table[index]);
+            if (resolution != conversionTier) continue;
+            
+            readConverted(index);
+            return true;
+        }
+        conversionTier++;
+        conversionIndex = 0;
+    }
+    return false;
+}
+
+void DallasTemperature::readConverted(DeviceIndex index) {
+    const uint8_t* deviceAddress = getDeviceTable()[index].address;
+    int32_t raw = readTemp(deviceAddress, 0, true);
+    if (_TemperatureHandler != nullptr) {
+        _TemperatureHandler(index, deviceAddress, raw);
+    }
+}
+
+#if REQUIRESROLLING
+// Keep an externally powered bus busy instead of converting everything,
+// idling through the conversion and then reading everything. The address
+// table is cut into up to ROLLING_GROUPS groups that convert in turn by
+// addressed STARTCONVO; while some groups convert, tick() reads the ones
+// whose conversion time has passed and starts them again, so readings
+// keep arriving through the temperature handler until stopRolling(). A
+// simulated bus of 32 sensors delivers about 42 samples a second this way
+// against 32 with broadcast sweeps. Not available on parasite power, which
+// needs the bus left alone while converting.
+bool DallasTemperature::startRolling(void) {
+    if (parasite || (conversionState != CONVERSION_IDLE && conversionState != CONVERSION_READY))
+        return false;
+    if (cachedDevices == 0) return false;
+    
+    rollingDevices = cachedDevices;
+    rollingGroups = (cachedDevices < ROLLING_GROUPS) ? (uint8_t)cachedDevices : ROLLING_GROUPS;
+    rollingStartIndex = 0;
+    rollingReadIndex = 0;
+    rollingStarting = 0;
+    rollingReading = 0;
+    rollingInFlight = 0;
+    conversionState = CONVERSION_ROLLING;
+    return true;
+}
+
+// Leave rolling mode; conversions still running are not read
+void DallasTemperature::stopRolling(void) {
+    if (conversionState == CONVERSION_ROLLING) conversionState = CONVERSION_IDLE;
+}
+
+// First table index of a rolling group, or the table size for the last + 1
+DeviceIndex DallasTemperature::rollingGroupStart(uint8_t group) {
+    return (DeviceIndex)((uint32_t)group * rollingDevices / rollingGroups);
+}
+
+// One transaction of rolling mode: start the next group once it has been
+// read, otherwise read the oldest group once its conversion time, counted
+// from its last start, has passed. Restarting each group as soon as it is
+// read spreads the groups out instead of letting their reads bunch up.
+// Groups are started and read in table order.
+void DallasTemperature::rollNext(void) {
+    // the table changed under the groups
+    if (rollingDevices != cachedDevices) {
+        conversionState = CONVERSION_IDLE;
+        startRolling();
+        return;
+    }
+    
+    DeviceInfo* table = getDeviceTable();
+    if (rollingInFlight < rollingGroups) {
+        DeviceIndex end = rollingGroupStart(rollingStarting + 1);
+        while (rollingStartIndex < end && !validFamily(table[rollingStartIndex].address)) rollingStartIndex++;
+        if (rollingStartIndex < end && busReset() != 0) {
+            busSelect(table[rollingStartIndex].address);
+            busWrite(STARTCONVO, false);
+        }
+        if (rollingStartIndex < end) rollingStartIndex++;
+        
+        if (rollingStartIndex >= end) {
+            rollingStarted[rollingStarting] = clockNow();
+            rollingInFlight++;
+            if (++rollingStarting == rollingGroups) {
+                rollingStarting = 0;
+                rollingStartIndex = 0;
+            }
+        }
+        return;
+    }
+    
+    if (clockNow() - rollingStarted[rollingReading] >= conversionWait(bitResolution) ||
+        rollingReadIndex != rollingGroupStart(rollingReading)) {
+        DeviceIndex end = rollingGroupStart(rollingReading + 1);
+        while (rollingReadIndex < end && !validFamily(table[rollingReadIndex].address)) rollingReadIndex++;
+        if (rollingReadIndex < end) readConverted(rollingReadIndex++);
+        
+        if (rollingReadIndex >= end) {
+            rollingInFlight--;
+            if (++rollingReading == rollingGroups) {
+                rollingReading = 0;
+                rollingReadIndex = 0;
+            }
+        }
+    }
+}
+#endif
+
+#if REQUIRESSCHEDULE
+// Sample a table device every period ms instead of with the rest of the
+// bus, 0 taking it off the schedule. When several devices are due, those
+// of higher priority are converted and read first. Call after begin(),
+// which clears the schedule.
+bool DallasTemperature::setSamplePeriod(const uint8_t* deviceAddress, unsigned long period, uint8_t priority) {
+    DeviceInfo* info = findDeviceInfo(deviceAddress);
+    if (info == nullptr || !validFamily(info->address)) return false;
+    deviceResolution(info);
+    
+    info->schedule.period = period;
+    info->schedule.priority = priority;
+    info->schedule.deadline = clockNow() + scheduleLead(info);
+    info->schedule.converting = false;
+    return true;
+}
+
+bool DallasTemperature::setSamplePeriodByIndex(DeviceIndex index, unsigned long period, uint8_t priority) {
+    if (index >= cachedDevices) return false;
+    return setSamplePeriod(getDeviceTable()[index].address, period, priority);
+}
+
+// Share of the scheduled devices that must be due at once before one Skip
+// ROM conversion replaces their addressed ones; above 100 never
+void DallasTemperature::setBroadcastPercent(uint8_t percent) {
+    broadcastPercent = percent;
+}
+
+// Run the sample periods from tick(), one bus transaction per call. Each
+// scheduled device is converted by addressed STARTCONVO just early enough
+// to be read by its deadline, and read once its conversion time has
+// passed, so devices that are not due cost no bus time; four 2 Hz sensors
+// and thirty 0.1 Hz ones keep a simulated bus under a fifth busy. When
+// several are due, higher priority goes first, and when enough are due at
+// once, see setBroadcastPercent(), one Skip ROM conversion starts them
+// all. Readings arrive through the temperature handler. Not available on
+// parasite power, which needs the bus left alone while converting.
+bool DallasTemperature::startScheduler(void) {
+    if (parasite || (conversionState != CONVERSION_IDLE && conversionState != CONVERSION_READY))
+        return false;
+    
+    conversionState = CONVERSION_SCHEDULED;
+    return true;
+}
+
+// Leave scheduled mode; conversions still running are not read
+void DallasTemperature::stopScheduler(void) {
+    if (conversionState != CONVERSION_SCHEDULED) return;
+    
+    DeviceInfo* table = getDeviceTable();
+    for (DeviceIndex i = 0; i < cachedDevices; i++) table[i].schedule.converting = false;
+    conversionState = CONVERSION_IDLE;
+}
+
+// Conversion time and read slack ahead of a deadline
+unsigned long DallasTemperature::scheduleLead(const DeviceInfo* info) {
+    return conversionWait(waitResolution(info)) + SCHEDULE_SLACK_MS;
+}
+
+// Whether a scheduled device needs the bus now: to be read once converted,
+// or to start converting in time for its deadline
+bool DallasTemperature::scheduleDue(DeviceInfo* info, unsigned long now) {
+    const DeviceSchedule& schedule = info->schedule;
+    if (schedule.converting) return (long)(now - schedule.readyAt) >= 0;
+    return (long)(now + scheduleLead(info) - schedule.deadline) >= 0;
+}
+
+// One transaction of scheduled mode for the due device of highest
+// priority, earliest deadline first: start its conversion or read it.
+// When enough devices must start at once, a single broadcast conversion
+// starts them all for less bus time than their addressed ones; devices
+// already converting are restarted by it and waited for again.
+void DallasTemperature::scheduleNext(void) {
+    DeviceInfo* table = getDeviceTable();
+    unsigned long now = clockNow();
+    DeviceIndex next = cachedDevices;
+    DeviceIndex scheduled = 0;
+    DeviceIndex starting = 0;
+    // a broadcast must not reach anything but table thermometers
+    bool broadcast = tableCoversBus();
+    
+    for (DeviceIndex i = 0; i < cachedDevices; i++) {
+        const DeviceSchedule& schedule = table[i].schedule;
+        if (!validFamily(table[i].address)) broadcast = false;
+        if (schedule.period == 0) continue;
+        scheduled++;
+        if (!scheduleDue(&table[i], now)) continue;
+        if (!schedule.converting) starting++;
+        
+        if (next == cachedDevices || schedule.priority > table[next].schedule.priority ||
+            (schedule.priority == table[next].schedule.priority &&
+             (long)(schedule.deadline - table[next].schedule.deadline) < 0)) {
+            next = i;
+        }
+    }
+    if (next == cachedDevices) return;
+    
+    DeviceSchedule& schedule = table[next].schedule;
+    if (schedule.converting) {
+        schedule.converting = false;
+        readConverted(next);
+        
+        // a device more than a period behind starts over from now
+        now = clockNow();
+        schedule.deadline += schedule.period;
+        if ((long)(now - schedule.deadline) > 0) schedule.deadline = now + schedule.period;
+        return;
+    }
+    
+    if (broadcast && starting > 1 && (uint32_t)starting * 100 >= (uint32_t)scheduled * broadcastPercent) {
+        if (busReset() != 0) {
+            busSkip();
+            busWrite(STARTCONVO, false);
+        }
+        now = clockNow();
+        for (DeviceIndex i = 0; i < cachedDevices; i++) {
+            DeviceSchedule& other = table[i].schedule;
+            if (other.period == 0 || !(other.converting || scheduleDue(&table[i], now))) continue;
+            other.converting = true;
+            other.readyAt = now + conversionWait(waitResolution(&table[i]));
+        }
+        return;
+    }
+    
+    if (busReset() != 0) {
+        busSelect(table[next].address);
+        busWrite(STARTCONVO, false);
+    }
+    schedule.converting = true;
+    schedule.readyAt = clockNow() + conversionWait(waitResolution(&table[next]));
+}
+#endif
+
+// Advance the conversion engine by at most one bus transaction: a status
+// poll while converting, then one scratchpad read per call. Queued EEPROM
+// operations, see setWaitForEeprom(), take their turn first. Only devices
+// held in the address table are read. On externally powered buses with
+// mixed resolutions, devices are read as soon as their own conversion
+// time has passed; the slower ones are then waited for by time since
+// polling no longer works once the bus has been used. Each device is
+// still converted and read once per sweep, see setSamplePeriod() for
+// sampling fast devices more often.
+DallasTemperature::conversion_state_t DallasTemperature::tick(void) {
+#if REQUIRESEEPROMQUEUE
+    // queued EEPROM work takes the bus first, except from a parasite
+    // conversion that still needs the strong pullup
+    if (eepromCount > 0 && !(parasite && conversionState == CONVERSION_CONVERTING)) {
+        serviceEeprom();
+        if (conversionState == CONVERSION_CONVERTING) conversionPolled = false;
+        return conversionState;
+    }
+#endif
+    
+    switch (conversionState) {
+        case CONVERSION_CONVERTING: {
+            unsigned long elapsed = clockNow() - conversionRequest.timestamp;
+            bool complete = conversionPolled ? isConversionComplete(conversionRequest)
+                                             : elapsed >= conversionWait(bitResolution);
+            if (complete) {
+                deactivateExternalPullup();
+                conversionState = CONVERSION_READING;
+            } else if (!parasite) {
+                uint8_t finished = 8;
+                while (finished < 12 && elapsed >= conversionWait(finished + 1)) finished++;
+                if (finished >= 9 && readNextConverted(finished)) {
+                    conversionPolled = false;
+                }
+            }
+            break;
+        }
+        
+        case CONVERSION_READING:
+            if (!readNextConverted(12)) {
+                conversionState = CONVERSION_READY;
+            }
+            break;
+        
+#if REQUIRESROLLING
+        case CONVERSION_ROLLING:
+            rollNext();
+            break;
+#endif
+        
+#if REQUIRESSCHEDULE
+        case CONVERSION_SCHEDULED:
+            scheduleNext();
+            break;
+#endif
+        
+        default:
+            break;
+    }
+    return conversionState;
+}
+
+DallasTemperature::conversion_state_t DallasTemperature::getConversionState(void) {
+    return conversionState;
+}
+
+// The request of the sweep started by startConversion(), for following it
+// with isConversionComplete(request_t) instead of tick()
+DallasTemperature::request_t DallasTemperature::getConversionRequest(void) {
+    return conversionRequest;
+}
+
+void DallasTemperature::setTemperatureHandler(TemperatureHandler* handler) {
+    _TemperatureHandler = handler;
+}
+
 void DallasTemperature::blockTillConversionComplete(uint8_t bitResolution) {
-    unsigned long start = millis();
+    unsigned long start = clockNow();
     blockTillConversionComplete(bitResolution, start);
 }
 
 void DallasTemperature::blockTillConversionComplete(uint8_t bitResolution, unsigned long start) {
+#if REQUIRESBUSSTATS
+    unsigned long blocked = clockNow();
+#endif
     if (checkForConversion && !parasite) {
-        while (!isConversionComplete() && ((unsigned long)(millis() - start) < (unsigned long)MAX_CONVERSION_TIMEOUT)) {
-            yield();
+        while (!pollConversion(start) && ((unsigned long)(clockNow() - start) < (unsigned long)MAX_CONVERSION_TIMEOUT)) {
+            clockIdle();
         }
     } else {
-        unsigned long delayInMillis = millisToWaitForConversion(bitResolution);
+        unsigned long delayInMillis = conversionWait(bitResolution);
         activateExternalPullup();
-        delay(delayInMillis);
+        clockWait(delayInMillis);
         deactivateExternalPullup();
     }
+#if REQUIRESBUSSTATS
+    busStats.conversionWaitMillis += clockNow() - blocked;
+#endif
 }
 
 void DallasTemperature::blockTillConversionComplete(uint8_t bitResolution, request_t req) {
@@ -527,6 +2247,72 @@ void DallasTemperature::blockTillConversionComplete(uint8_t bitResolution, reque
     }
 }
 
+uint8_t DallasTemperature::busReset(void) {
+#if REQUIRESEEPROMQUEUE
+    if (eepromRunning) {
+        if (parasite && eepromQueue[eepromHead].command == COPYSCRATCH) {
+            // the running copy needs the strong pullup until it is done
+            unsigned long elapsed = clockNow() - eepromStart;
+            if (elapsed < MAX_EEPROM_WRITE_TIME) {
+                clockWait(MAX_EEPROM_WRITE_TIME - elapsed);
+#if REQUIRESBUSSTATS
+                busStats.eepromWaitMillis += MAX_EEPROM_WRITE_TIME - elapsed;
+#endif
+            }
+            serviceEeprom();
+        } else {
+            eepromPolled = false;
+        }
+    }
+#endif
+    uint8_t b = _wire->reset();
+#if REQUIRESBUSSTATS
+    busStats.resets++;
+    if (b == 0) busStats.presenceFailures++;
+#endif
+    return b;
+}
+
+void DallasTemperature::busSelect(const uint8_t* deviceAddress) {
+    _wire->select(deviceAddress);
+#if REQUIRESBUSSTATS
+    busStats.bytesWritten += 9;
+#endif
+}
+
+void DallasTemperature::busSkip(void) {
+    _wire->skip();
+#if REQUIRESBUSSTATS
+    busStats.bytesWritten++;
+#endif
+}
+
+void DallasTemperature::busWrite(uint8_t value, uint8_t power) {
+    _wire->write(value, power);
+#if REQUIRESBUSSTATS
+    busStats.bytesWritten++;
+#endif
+}
+
+uint8_t DallasTemperature::busRead(void) {
+#if REQUIRESBUSSTATS
+    busStats.bytesRead++;
+#endif
+    return _wire->read();
+}
+
+#if REQUIRESBUSSTATS
+
+DallasTemperature::BusStats DallasTemperature::getBusStats(void) {
+    return busStats;
+}
+
+void DallasTemperature::resetBusStats(void) {
+    memset(&busStats, 0, sizeof(busStats));
+}
+
+#endif
+
 int32_t DallasTemperature::calculateTemperature(const uint8_t* deviceAddress, uint8_t* scratchPad) {
     int32_t fpTemperature = 0;
 
@@ -536,7 +2322,7 @@ int32_t DallasTemperature::calculateTemperature(const uint8_t* deviceAddress, ui
         neg = 0xFFF80000;
 
     // detect MAX31850
-    if (deviceAddress[0] == DS1825MODEL && scratchPad[CONFIGURATION] & 0x80) {
+    if (isFamily(deviceAddress, DS1825MODEL) && scratchPad[CONFIGURATION] & 0x80) {
         if (scratchPad[TEMP_LSB] & 1) { // Fault Detected
             if (scratchPad[HIGH_ALARM_TEMP] & 1) {
                 return DEVICE_FAULT_OPEN_RAW;
@@ -583,7 +2369,7 @@ int32_t DallasTemperature::calculateTemperature(const uint8_t* deviceAddress, ui
    See - http://myarduinotoy.blogspot.co.uk/2013/02/12bit-result-from-ds18s20.html
    */
   
-  if ((deviceAddress[DSROM_FAMILY] == DS18S20MODEL) && (scratchPad[COUNT_PER_C] != 0)) {
+  if (isFamily(deviceAddress, DS18S20MODEL) && (scratchPad[COUNT_PER_C] != 0)) {
     fpTemperature = (((fpTemperature & 0xfff0) << 3) - 32
                     + (((scratchPad[COUNT_PER_C] - scratchPad[COUNT_REMAIN]) << 7)
                        / scratchPad[COUNT_PER_C])) | neg;
@@ -604,9 +2390,9 @@ void DallasTemperature::setHighAlarmTemp(const uint8_t* deviceAddress, int8_t ce
     else if (celsius < -55) celsius = -55;
 
     ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad)) {
+    if (readStagedScratchPad(deviceAddress, scratchPad) && scratchPad[HIGH_ALARM_TEMP] != (uint8_t)celsius) {
         scratchPad[HIGH_ALARM_TEMP] = (uint8_t)celsius;
-        writeScratchPad(deviceAddress, scratchPad);
+        storeScratchPad(deviceAddress, scratchPad);
     }
 }
 
@@ -616,22 +2402,22 @@ void DallasTemperature::setLowAlarmTemp(const uint8_t* deviceAddress, int8_t cel
     else if (celsius < -55) celsius = -55;
 
     ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad)) {
+    if (readStagedScratchPad(deviceAddress, scratchPad) && scratchPad[LOW_ALARM_TEMP] != (uint8_t)celsius) {
         scratchPad[LOW_ALARM_TEMP] = (uint8_t)celsius;
-        writeScratchPad(deviceAddress, scratchPad);
+        storeScratchPad(deviceAddress, scratchPad);
     }
 }
 
 int8_t DallasTemperature::getHighAlarmTemp(const uint8_t* deviceAddress) {
     ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad))
+    if (readStagedScratchPad(deviceAddress, scratchPad))
         return (int8_t)scratchPad[HIGH_ALARM_TEMP];
     return DEVICE_DISCONNECTED_C;
 }
 
 int8_t DallasTemperature::getLowAlarmTemp(const uint8_t* deviceAddress) {
     ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad))
+    if (readStagedScratchPad(deviceAddress, scratchPad))
         return (int8_t)scratchPad[LOW_ALARM_TEMP];
     return DEVICE_DISCONNECTED_C;
 }
@@ -652,10 +2438,10 @@ bool DallasTemperature::alarmSearch(uint8_t* newAddr) {
     if (alarmSearchExhausted)
         return false;
 
-    if (!_wire->reset())
+    if (!busReset())
         return false;
 
-    _wire->write(ALARMSEARCH);
+    busWrite(ALARMSEARCH);
 
     for (i = 0; i < 64; i++) {
         uint8_t a = _wire->read_bit();
@@ -750,42 +2536,29 @@ void DallasTemperature::operator delete(void* p) {
 
 #endif
 
+// True when the bus holds more devices than last known. Only the
+// differences are probed, see scanForChanges().
 bool DallasTemperature::verifyDeviceCount(void) {
-    uint8_t actualCount = 0;
-    float temp;
-    
-    requestTemperatures();
-    
-    do {
-        temp = getTempCByIndex(actualCount);
-        if (temp > DEVICE_DISCONNECTED_C) {
-            actualCount++;
-        }
-    } while (temp > DEVICE_DISCONNECTED_C && actualCount < 255);
-    
-    if (actualCount > devices) {
-        devices = actualCount;
-        begin();
-        return true;
-    }
-    
-    return false;
+    DeviceIndex known = devices;
+    scanForChanges();
+    return devices > known;
 }
 
 void DallasTemperature::setUserData(const uint8_t* deviceAddress, int16_t data) {
+    ScratchPad scratchPad;
+    if (!readStagedScratchPad(deviceAddress, scratchPad))
+        return;
+
     // return when stored value == new value
-    if (getUserData(deviceAddress) == data)
+    if (scratchPad[HIGH_ALARM_TEMP] == (uint8_t)(data >> 8) && scratchPad[LOW_ALARM_TEMP] == (uint8_t)(data & 255))
         return;
 
-    ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad)) {
-        scratchPad[HIGH_ALARM_TEMP] = data >> 8;
-        scratchPad[LOW_ALARM_TEMP] = data & 255;
-        writeScratchPad(deviceAddress, scratchPad);
-    }
+    scratchPad[HIGH_ALARM_TEMP] = data >> 8;
+    scratchPad[LOW_ALARM_TEMP] = data & 255;
+    storeScratchPad(deviceAddress, scratchPad);
 }
 
-void DallasTemperature::setUserDataByIndex(uint8_t deviceIndex, int16_t data) {
+void DallasTemperature::setUserDataByIndex(DeviceIndex deviceIndex, int16_t data) {
     DeviceAddress deviceAddress;
     if (getAddress(deviceAddress, deviceIndex)) {
         setUserData((uint8_t*)deviceAddress, data);
@@ -795,15 +2568,15 @@ void DallasTemperature::setUserDataByIndex(uint8_t deviceIndex, int16_t data) {
 int16_t DallasTemperature::getUserData(const uint8_t* deviceAddress) {
     int16_t data = 0;
     ScratchPad scratchPad;
-    if (isConnected(deviceAddress, scratchPad)) {
+    if (readStagedScratchPad(deviceAddress, scratchPad)) {
         data = scratchPad[HIGH_ALARM_TEMP] << 8;
         data += scratchPad[LOW_ALARM_TEMP];
     }
     return data;
 }
 
-int16_t DallasTemperature::getUserDataByIndex(uint8_t deviceIndex) {
+int16_t DallasTemperature::getUserDataByIndex(DeviceIndex deviceIndex) {
     DeviceAddress deviceAddress;
-    getAddress(deviceAddress, deviceIndex);
+    if (!getAddress(deviceAddress, deviceIndex)) return 0;
     return getUserData((uint8_t*)deviceAddress);
 }
\ No newline at end of file
@@ -12,6 +12,114 @@
 #define REQUIRESALARMS true
 #endif
 
+// Device families compiled in. Families left out are treated like any
+// other 1-Wire device and their special cases (DS18S20 extended
+// resolution, MAX31850 faults, ...) are dropped from the build, e.g.
+// #define REQUIRESFAMILIES DS18B20_FAMILY for boards with only DS18B20s.
+#define DS18S20_FAMILY  0x01
+#define DS18B20_FAMILY  0x02
+#define DS1822_FAMILY   0x04
+#define DS1825_FAMILY   0x08  // also MAX31850
+#define DS28EA00_FAMILY 0x10
+#define ALL_FAMILIES    0x1F
+#ifndef REQUIRESFAMILIES
+#define REQUIRESFAMILIES ALL_FAMILIES
+#endif
+
+// Float getters and conversions; integer-only firmware can drop them, see
+// getTempMilliC()
+#ifndef REQUIRESFLOAT
+#define REQUIRESFLOAT true
+#endif
+
+// Count bus transactions, errors and blocking time, see getBusStats()
+#ifndef REQUIRESBUSSTATS
+#define REQUIRESBUSSTATS false
+#endif
+
+// Track read health per device and quarantine failing ones, see getTemp()
+#ifndef REQUIRESHEALTH
+#if defined(__AVR__)
+#define REQUIRESHEALTH false
+#else
+#define REQUIRESHEALTH true
+#endif
+#endif
+
+// Per-device sample periods run by tick(), see startScheduler()
+#ifndef REQUIRESSCHEDULE
+#if defined(__AVR__)
+#define REQUIRESSCHEDULE false
+#else
+#define REQUIRESSCHEDULE true
+#endif
+#endif
+
+// Number of devices begin() keeps in its address table, so index based
+// calls resolve without a ROM search. Devices beyond the table are still
+// reachable, at the cost of a search. 0 disables the built-in table; do
+// so when every instance is given its own, see setDeviceTable(), since
+// the built-in one is allocated in each instance whether used or not.
+#ifndef DEVICE_CACHE_SIZE
+#if defined(__AVR__)
+#define DEVICE_CACHE_SIZE 8
+#else
+#define DEVICE_CACHE_SIZE 32
+#endif
+#endif
+
+// EEPROM copies and recalls held for tick() when not waiting for them,
+// see setWaitForEeprom()
+#ifndef REQUIRESEEPROMQUEUE
+#if defined(__AVR__)
+#define REQUIRESEEPROMQUEUE false
+#else
+#define REQUIRESEEPROMQUEUE true
+#endif
+#endif
+
+// Room for one operation per table device and a Skip ROM one, so that
+// configuring every device never finds the queue full
+#ifndef EEPROM_QUEUE_SIZE
+#if DEVICE_CACHE_SIZE < 4
+#define EEPROM_QUEUE_SIZE 4
+#elif DEVICE_CACHE_SIZE > 254
+#define EEPROM_QUEUE_SIZE 255
+#else
+#define EEPROM_QUEUE_SIZE (DEVICE_CACHE_SIZE + 1)
+#endif
+#endif
+
+// Rolling conversions run by tick(), see startRolling()
+#ifndef REQUIRESROLLING
+#if defined(__AVR__)
+#define REQUIRESROLLING false
+#else
+#define REQUIRESROLLING true
+#endif
+#endif
+
+// Groups of table devices converting at once in rolling mode, see
+// startRolling(). More groups keep more conversions in flight, at the cost
+// of a timestamp each.
+#ifndef ROLLING_GROUPS
+#if defined(__AVR__)
+#define ROLLING_GROUPS 4
+#else
+#define ROLLING_GROUPS 8
+#endif
+#endif
+
+// Width of device indices and counts, see DeviceIndex. 8 bits limit a bus
+// to 255 devices; 16 bits lift that for long runs with repeaters.
+#ifndef DEVICE_INDEX_BITS
+#if defined(__AVR__)
+#define DEVICE_INDEX_BITS 8
+#else
+#define DEVICE_INDEX_BITS 16
+#endif
+#endif
+
 // Includes
 #include <inttypes.h>
 #include <Arduino.h>
@@ -33,6 +141,10 @@
 #define DEVICE_DISCONNECTED_C -127
 #define DEVICE_DISCONNECTED_F -196.6
 #define DEVICE_DISCONNECTED_RAW -7040
+#define DEVICE_DISCONNECTED_MILLIC -127000L
+#define DEVICE_DISCONNECTED_MILLIF -196600L
+#define DEVICE_DISCONNECTED_CENTIC -12700
+#define DEVICE_DISCONNECTED_CENTIF -19660
 
 #define DEVICE_FAULT_OPEN_C -254
 #define DEVICE_FAULT_OPEN_F -425.199982
@@ -48,11 +160,25 @@
 
 // Configuration Constants
 #define MAX_CONVERSION_TIMEOUT 750
+#define MAX_EEPROM_WRITE_TIME 20   // ms; NV write cycle is 10 ms max, with margin
+#define CONVERSION_MARGIN_PERCENT 6  // added to learned conversion times
 #define MAX_INITIALIZATION_RETRIES 3
 #define INITIALIZATION_DELAY_MS 50
+#define QUARANTINE_THRESHOLD 0     // consecutive failed reads before quarantine, 0 for off
+#define QUARANTINE_MAX_BACKOFF 6   // probe at least every 2^n reads
+#define CRC_RETRY_PERCENT 25       // CRC error rate above which one retry is left
+#define DEVICE_TABLE_FORMAT 2      // layout written by saveDeviceTable()
+#define SCHEDULE_SLACK_MS 20       // read time allowed for before a deadline
+#define SCHEDULE_BROADCAST_PERCENT 50  // of scheduled devices due at once
 
 typedef uint8_t DeviceAddress[8];
 
+#if DEVICE_INDEX_BITS > 8
+typedef uint16_t DeviceIndex;
+#else
+typedef uint8_t DeviceIndex;
+#endif
+
 class DallasTemperature {
 public:
     struct request_t {
@@ -60,7 +186,142 @@ public:
         unsigned long timestamp;
         operator bool() { return result; }
     };
-    
+
+#if REQUIRESHEALTH
+    // Read history of a device in the address table
+    struct DeviceHealth {
+        uint8_t failures;        // consecutive failed reads
+        uint8_t reads;           // read attempts, halved with crcErrors when full
+        uint8_t crcErrors;
+        uint8_t backoff;         // quarantine level, 0 when healthy
+        uint8_t skip;            // reads to skip before the next probe
+        int32_t lastRaw;         // last good reading, as getTemp()
+        unsigned long lastGood;  // clock time of the last good reading
+    };
+#endif
+
+#if REQUIRESSCHEDULE
+    // Sampling plan of a device in the address table, see setSamplePeriod()
+    struct DeviceSchedule {
+        unsigned long period;    // ms between readings, 0 when not scheduled
+        unsigned long deadline;  // clock time the next reading is wanted by
+        unsigned long readyAt;   // clock time its conversion ends
+        uint8_t priority;        // higher is served first
+        bool converting;
+    };
+#endif
+
+    // Address table entry filled in by begin()
+    struct DeviceInfo {
+        DeviceAddress address;
+        uint8_t resolution;   // 0 when unknown, and for devices that are not thermometers
+        bool parasite;
+        bool shadowValid;     // shadow matches the device or holds staged edits
+        bool dirty;           // shadow holds edits waiting for commit()
+        uint8_t shadow[3];    // TH, TL and configuration
+#if REQUIRESHEALTH
+        DeviceHealth health;
+#endif
+#if REQUIRESSCHEDULE
+        DeviceSchedule schedule;
+#endif
+        uint8_t family() const { return address[0]; }
+    };
+
+    // Where saveDeviceTable() keeps the address table between boots, e.g.
+    // EEPROM, flash or a file. Both calls return false on failure.
+    class Storage {
+    public:
+        virtual bool read(uint16_t offset, uint8_t* data, uint16_t length) = 0;
+        virtual bool write(uint16_t offset, const uint8_t* data, uint16_t length) = 0;
+    protected:
+        ~Storage() {}
+    };
+
+    // Time source and wait strategy used for every timestamp and wait,
+    // see setClock(). idle() is called between status polls: yield to
+    // an RTOS, or sleep until a timer fires.
+    class Clock {
+    public:
+        virtual unsigned long now(void) = 0;       // milliseconds
+        virtual void wait(unsigned long ms) = 0;   // at least ms
+        virtual void idle(void) = 0;
+    protected:
+        ~Clock() {}
+    };
+
+    // States of the non-blocking conversion engine, see tick()
+    enum conversion_state_t : uint8_t {
+        CONVERSION_IDLE,
+        CONVERSION_CONVERTING,
+        CONVERSION_READING,
+        CONVERSION_READY,
+        CONVERSION_ROLLING,     // see startRolling()
+        CONVERSION_SCHEDULED    // see startScheduler()
+    };
+
+    typedef void TemperatureHandler(DeviceIndex, const uint8_t*, int32_t);
+
+    // Called by scanForChanges() with true for a new device, false for a gone one
+    typedef void DeviceChangeHandler(const uint8_t*, bool);
+
+#if REQUIRESEEPROMQUEUE
+    // Called by tick() as each queued EEPROM copy or recall finishes, with
+    // false when the device did not answer
+    typedef void EepromHandler(const uint8_t*, bool);
+#endif
+
+    // Outcome of a scratchpad read, see Reading
+    enum reading_status_t : uint8_t {
+        READING_OK,
+        READING_DISCONNECTED,   // no presence pulse, or the device did not answer
+        READING_CRC_ERROR,
+        READING_FAULT,          // MAX31850 thermocouple fault, raw holds the code
+        READING_UNSUPPORTED,    // not a temperature device
+        READING_QUARANTINED     // skipped, the device keeps failing
+    };
+
+    // How getTemp() and getReading() read a sensor, see setReadMode()
+    enum read_mode_t : uint8_t {
+        READ_FULL,           // whole scratchpad, CRC checked
+        READ_FAST,           // temperature bytes only, implausible values re-read in full
+        READ_FAST_ONLY       // temperature bytes only, implausible values reported as disconnected
+    };
+
+    // One sensor's result from readAll()
+    struct Reading {
+        int32_t raw;              // 1/128 C, or a DEVICE_*_RAW code
+        unsigned long timestamp;  // clock time when it was read, see setClock()
+        uint8_t status;           // reading_status_t
+        bool crcOk;
+    };
+
+    // Statically sized storage for N devices: the address table and the
+    // latest reading of each, side by side in one block whose RAM use,
+    // bytes, is known at compile time. See setDeviceTable(), and
+    // DEVICE_CACHE_SIZE to drop the built-in table it replaces.
+    template <DeviceIndex N>
+    struct DeviceTable {
+        DeviceInfo devices[N];
+        Reading readings[N];
+        static constexpr DeviceIndex capacity = N;
+        static constexpr size_t bytes = N * (sizeof(DeviceInfo) + sizeof(Reading));
+    };
+
+#if REQUIRESBUSSTATS
+    // Counters since construction or the last resetBusStats()
+    struct BusStats {
+        uint32_t resets;
+        uint32_t presenceFailures;
+        uint32_t bytesWritten;
+        uint32_t bytesRead;
+        uint32_t crcErrors;             // scratchpad reads failing their CRC
+        uint32_t retries;               // extra attempts made by getTemp()
+        uint32_t conversionWaitMillis;  // blocked in blockTillConversionComplete()
+        uint32_t eepromWaitMillis;      // blocked waiting for EEPROM copies
+    };
+#endif
+
     // Constructors
     DallasTemperature();
     DallasTemperature(OneWire*);
@@ -69,15 +330,40 @@ public:
     // Setup & Configuration
     void setOneWire(OneWire*);
     void setPullupPin(uint8_t);
+    void setClock(Clock*);
+    Clock* getClock(void);
     void begin(void);
+    bool begin(Storage*);
+    DeviceIndex rescan(void);
+    void setDeviceTable(DeviceInfo*, DeviceIndex);
+    template <DeviceIndex N>
+    void setDeviceTable(DeviceTable<N>& table) {
+        setDeviceTable(table.devices, N);
+        readingTable = table.readings;
+    }
+    DeviceIndex scanForChanges(void);
+    void setDeviceChangeHandler(DeviceChangeHandler*);
     bool verifyDeviceCount(void);
+    bool saveDeviceTable(Storage*);
+    static uint16_t deviceTableStorageSize(DeviceIndex);
 
     // Device Information
-    uint8_t getDeviceCount(void);
-    uint8_t getDS18Count(void);
+    DeviceIndex getDeviceCount(void);
+    DeviceIndex getDS18Count(void);
     bool validAddress(const uint8_t*);
     bool validFamily(const uint8_t* deviceAddress);
-    bool getAddress(uint8_t*, uint8_t);
+    static constexpr bool supportsFamily(uint8_t family) {
+        return (family == DS18S20MODEL)  ? (REQUIRESFAMILIES & DS18S20_FAMILY) != 0
+             : (family == DS18B20MODEL)  ? (REQUIRESFAMILIES & DS18B20_FAMILY) != 0
+             : (family == DS1822MODEL)   ? (REQUIRESFAMILIES & DS1822_FAMILY) != 0
+             : (family == DS1825MODEL)   ? (REQUIRESFAMILIES & DS1825_FAMILY) != 0
+             : (family == DS28EA00MODEL) ? (REQUIRESFAMILIES & DS28EA00_FAMILY) != 0
+             : false;
+    }
+    void setFamilySearch(bool);
+    bool getFamilySearch(void);
+    bool getAddress(uint8_t*, DeviceIndex);
+    const DeviceInfo* getDeviceInfo(DeviceIndex);
     bool isConnected(const uint8_t*);
     bool isConnected(const uint8_t*, uint8_t*);
 
@@ -97,30 +383,88 @@ public:
     bool getWaitForConversion(void);
     void setCheckForConversion(bool);
     bool getCheckForConversion(void);
+    void setLearnConversionTime(bool);
+    bool getLearnConversionTime(void);
 
     // Temperature Operations
     request_t requestTemperatures(void);
     request_t requestTemperaturesByAddress(const uint8_t*);
-    request_t requestTemperaturesByIndex(uint8_t);
+    request_t requestTemperaturesByIndex(DeviceIndex);
     int32_t getTemp(const uint8_t*, byte retryCount = 0);
+#if REQUIRESFLOAT
     float getTempC(const uint8_t*, byte retryCount = 0);
     float getTempF(const uint8_t*);
-    float getTempCByIndex(uint8_t);
-    float getTempFByIndex(uint8_t);
+    float getTempCByIndex(DeviceIndex);
+    float getTempFByIndex(DeviceIndex);
+#endif
+    int32_t getTempMilliC(const uint8_t*, byte retryCount = 0);
+    int32_t getTempMilliF(const uint8_t*);
+    int32_t getTempMilliCByIndex(DeviceIndex);
+    int32_t getTempMilliFByIndex(DeviceIndex);
+
+    // Read Mode
+    void setReadMode(read_mode_t);
+    read_mode_t getReadMode(void);
+
+#if REQUIRESHEALTH
+    // Sensor Health
+    void setQuarantineThreshold(uint8_t);
+    bool isQuarantined(const uint8_t*);
+    void resetHealth(void);
+#endif
+
+    // Batched Reads
+    bool getReading(const uint8_t*, Reading*);
+    bool getReadingByIndex(DeviceIndex, Reading*);
+    DeviceIndex readAll(Reading*, size_t);
+    const Reading* getLatestReading(DeviceIndex);
 
     // Conversion Status
     bool isParasitePowerMode(void);
     bool isConversionComplete(void);
+    bool isConversionComplete(request_t);
     static uint16_t millisToWaitForConversion(uint8_t);
     uint16_t millisToWaitForConversion();
 
+    // Non-blocking Conversion
+    bool startConversion(void);
+    void stopConversion(void);
+    conversion_state_t tick(void);
+    conversion_state_t getConversionState(void);
+    request_t getConversionRequest(void);
+#if REQUIRESROLLING
+    bool startRolling(void);
+    void stopRolling(void);
+#endif
+
+#if REQUIRESSCHEDULE
+    // Scheduled Sampling
+    bool setSamplePeriod(const uint8_t*, unsigned long, uint8_t = 0);
+    bool setSamplePeriodByIndex(DeviceIndex, unsigned long, uint8_t = 0);
+    void setBroadcastPercent(uint8_t);
+    bool startScheduler(void);
+    void stopScheduler(void);
+#endif
+    void setTemperatureHandler(TemperatureHandler*);
+
     // EEPROM Operations
-    bool saveScratchPadByIndex(uint8_t);
+    bool saveScratchPadByIndex(DeviceIndex);
     bool saveScratchPad(const uint8_t* = nullptr);
-    bool recallScratchPadByIndex(uint8_t);
+    bool recallScratchPadByIndex(DeviceIndex);
     bool recallScratchPad(const uint8_t* = nullptr);
     void setAutoSaveScratchPad(bool);
     bool getAutoSaveScratchPad(void);
+#if REQUIRESEEPROMQUEUE
+    void setWaitForEeprom(bool);
+    bool getWaitForEeprom(void);
+    uint8_t getPendingEeprom(void);
+    void setEepromHandler(EepromHandler*);
+#endif
+
+    // Deferred Scratchpad Writes
+    void setDeferredWrites(bool);
+    bool getDeferredWrites(void);
+    DeviceIndex commit(void);
 
 #if REQUIRESALARMS
     typedef void AlarmHandler(const uint8_t*);
@@ -139,22 +483,67 @@ public:
 
     // User Data Operations
     void setUserData(const uint8_t*, int16_t);
-    void setUserDataByIndex(uint8_t, int16_t);
+    void setUserDataByIndex(DeviceIndex, int16_t);
     int16_t getUserData(const uint8_t*);
-    int16_t getUserDataByIndex(uint8_t);
+    int16_t getUserDataByIndex(DeviceIndex);
 
+#if REQUIRESFLOAT
     // Temperature Conversion Utilities
     static float toFahrenheit(float);
     static float toCelsius(float);
     static float rawToCelsius(int32_t);
     static int16_t celsiusToRaw(float);
     static float rawToFahrenheit(int32_t);
+#endif
+
+    // Integer Temperature Conversion Utilities, rounded half away from zero.
+    // Disconnected and fault readings map to the DEVICE_DISCONNECTED_* codes.
+    static constexpr int32_t rawToMilliCelsius(int32_t raw) {
+        return (raw <= DEVICE_DISCONNECTED_RAW) ? DEVICE_DISCONNECTED_MILLIC
+               : (raw * 125 + (raw < 0 ? -8 : 8)) / 16;
+    }
+    static constexpr int32_t rawToMilliFahrenheit(int32_t raw) {
+        return (raw <= DEVICE_DISCONNECTED_RAW) ? DEVICE_DISCONNECTED_MILLIF
+               : (raw * 225 + 512000 + (raw * 225 < -512000 ? -8 : 8)) / 16;
+    }
+    static constexpr int32_t rawToCentiCelsius(int32_t raw) {
+        return (raw <= DEVICE_DISCONNECTED_RAW) ? DEVICE_DISCONNECTED_CENTIC
+               : (raw * 25 + (raw < 0 ? -16 : 16)) / 32;
+    }
+    static constexpr int32_t rawToCentiFahrenheit(int32_t raw) {
+        return (raw <= DEVICE_DISCONNECTED_RAW) ? DEVICE_DISCONNECTED_CENTIF
+               : (raw * 45 + 102400 + (raw * 45 < -102400 ? -16 : 16)) / 32;
+    }
+    static constexpr int32_t milliCelsiusToRaw(int32_t milliCelsius) {
+        return (milliCelsius * 16 + (milliCelsius < 0 ? -62 : 62)) / 125;
+    }
+    static constexpr int32_t milliCelsiusToMilliFahrenheit(int32_t milliCelsius) {
+        return (milliCelsius * 9 + 160000 + (milliCelsius * 9 < -160000 ? -2 : 2)) / 5;
+    }
+    static constexpr int32_t milliFahrenheitToMilliCelsius(int32_t milliFahrenheit) {
+        return ((milliFahrenheit - 32000) * 5 + (milliFahrenheit < 32000 ? -4 : 4)) / 9;
+    }
+    // Alarm threshold for setHighAlarmTemp()/setLowAlarmTemp(): the whole
+    // degree the device compares against, rounded down and kept in range
+    static constexpr int8_t milliCelsiusToAlarm(int32_t milliCelsius) {
+        return (milliCelsius >= 125000) ? 125 : (milliCelsius <= -55000) ? -55
+               : (int8_t)((milliCelsius >= 0) ? milliCelsius / 1000 : -((999 - milliCelsius) / 1000));
+    }
+    static constexpr int32_t alarmToMilliCelsius(int8_t celsius) {
+        return (int32_t)celsius * 1000;
+    }
 
 #if REQUIRESNEW
     void* operator new(unsigned int);
     void operator delete(void*);
 #endif
 
+#if REQUIRESBUSSTATS
+    // Bus Statistics
+    BusStats getBusStats(void);
+    void resetBusStats(void);
+#endif
+
     // Conversion Completion Methods
     void blockTillConversionComplete(uint8_t);
     void blockTillConversionComplete(uint8_t, unsigned long);
@@ -163,6 +552,15 @@ public:
 private:
     typedef uint8_t ScratchPad[9];
 
+#if REQUIRESEEPROMQUEUE
+    // A queued EEPROM operation, see serviceEeprom()
+    struct EepromOperation {
+        DeviceAddress address;
+        bool all;                 // Skip ROM: every device
+        uint8_t command;          // COPYSCRATCH or RECALLSCRATCH
+    };
+#endif
+
     // Internal State
     bool parasite;
     bool useExternalPullup;
@@ -171,15 +569,142 @@ private:
     bool waitForConversion;
     bool checkForConversion;
     bool autoSaveScratchPad;
-    uint8_t devices;
-    uint8_t ds18Count;
+    bool deferredWrites;
+    bool familySearch;
+    read_mode_t readMode;
+    DeviceIndex devices;
+    DeviceIndex ds18Count;
     OneWire* _wire;
+    Clock* _clock;
+
+    // Device address table
+    DeviceInfo* deviceTable;
+    DeviceIndex deviceTableSize;
+    DeviceIndex cachedDevices;
+    DeviceIndex lookupHint;     // last entry found by address, see findDeviceInfo()
+    Reading* readingTable;      // latest readings, parallel to the table
+#if DEVICE_CACHE_SIZE > 0
+    DeviceInfo deviceCache[DEVICE_CACHE_SIZE];
+#endif
+
+    // Family search state, see searchNext()
+    DeviceAddress searchAddress;
+    int8_t searchJunction;
+    bool searchExhausted;
+    bool foreignDevices;        // a family search passed over other devices
+
+    // Non-blocking conversion engine
+    conversion_state_t conversionState;
+    DeviceIndex conversionIndex;
+    uint8_t conversionTier;     // resolution being read, fastest first
+    bool conversionPolled;      // the bus was left alone, polling still works
+    request_t conversionRequest;
+    TemperatureHandler* _TemperatureHandler;
+    DeviceChangeHandler* _DeviceChangeHandler;
+
+#if REQUIRESROLLING
+    // Rolling conversions, groups started and read in turn, see rollNext()
+    DeviceIndex rollingDevices;     // table size the groups were cut for
+    DeviceIndex rollingStartIndex;  // next device to start converting
+    DeviceIndex rollingReadIndex;   // next device to read
+    uint8_t rollingGroups;
+    uint8_t rollingStarting;        // group being started
+    uint8_t rollingReading;         // oldest group converting
+    uint8_t rollingInFlight;        // groups started and not yet read
+    unsigned long rollingStarted[ROLLING_GROUPS];  // last start in each group
+#endif
+
+    // Learned conversion time, see conversionWait()
+    bool learnConversionTime;
+    uint16_t conversionScale;   // 256ths of the datasheet time, 0 until measured
+    uint8_t pollResolution;     // the last conversion started, see pollConversion()
+    unsigned long pollStart;
+    unsigned long pollBusyAt;   // elapsed time of its last busy poll
+    bool pollBusy;
+    bool pollBroadcast;         // Skip ROM: the poll waits for the slowest device
+
+#if REQUIRESEEPROMQUEUE
+    // Non-blocking EEPROM queue, oldest first
+    EepromOperation eepromQueue[EEPROM_QUEUE_SIZE];
+    uint8_t eepromHead;
+    uint8_t eepromCount;        // queued, the running one included
+    bool eepromRunning;
+    bool eepromPolled;          // the bus was left alone since the command
+    unsigned long eepromStart;
+    bool waitForEeprom;
+    EepromHandler* _EepromHandler;
+#endif
+
+    // Family test that folds to false at compile time for a family left
+    // out of REQUIRESFAMILIES, taking its code with it
+    static constexpr bool isFamily(const uint8_t* deviceAddress, uint8_t family) {
+        return supportsFamily(family) && deviceAddress[0] == family;
+    }
 
     // Internal Methods
+    DeviceInfo* getDeviceTable(void);
+    DeviceIndex getDeviceTableSize(void);
     int32_t calculateTemperature(const uint8_t*, uint8_t*);
     bool isAllZeros(const uint8_t* const scratchPad, const size_t length = 9);
+    bool readScratchPadBytes(const uint8_t*, uint8_t*, uint8_t);
+    void sendScratchPad(const uint8_t*, const uint8_t*);
+    uint8_t readScratchPadChecked(const uint8_t*, uint8_t*);
+    uint8_t readTemperatureFast(const uint8_t*, int32_t*);
+    uint8_t readTemperature(const uint8_t*, byte, int32_t*, DeviceInfo*, bool*);
+    DeviceInfo* findDeviceInfo(const uint8_t*);
+    void probeDevice(DeviceInfo*, const uint8_t*);
+    void moveEntries(DeviceIndex, DeviceIndex, DeviceIndex);
+    void storeReading(DeviceInfo*, const Reading&);
+    bool readReading(const uint8_t*, Reading*, DeviceInfo*);
+    int32_t readTemp(const uint8_t*, byte, bool);
+    bool restoreDeviceTable(Storage*);
+    bool verifyDevice(const DeviceInfo*);
+    bool romPresent(const uint8_t*);
+    static int8_t searchOrder(const uint8_t*, const uint8_t*);
+    static bool validFamilyPrefix(uint8_t, uint8_t);
+    void resetSearch(void);
+    bool searchNext(uint8_t*);
+    bool readStagedScratchPad(const uint8_t*, uint8_t*);
+    void storeScratchPad(const uint8_t*, const uint8_t*);
+    void updateShadow(DeviceInfo*, const uint8_t*);
+    bool tableCoversBus(void);
+    bool uniformScratchPad(uint8_t*, bool);
+    void broadcastScratchPad(const uint8_t*);
+    void forgetShadow(const uint8_t*);
+#if REQUIRESEEPROMQUEUE
+    bool queueEeprom(const uint8_t*, uint8_t);
+    void serviceEeprom(void);
+    void finishEeprom(bool);
+    void reportEeprom(const EepromOperation&, bool);
+#endif
+    static uint8_t configurationFor(uint8_t);
+    void updateBitResolution(void);
+    uint8_t waitResolution(const DeviceInfo*);
+    uint8_t deviceResolution(DeviceInfo*);
+    void fillResolution(DeviceInfo*, const uint8_t*);
+    bool readNextConverted(uint8_t);
+    void readConverted(DeviceIndex);
+#if REQUIRESROLLING
+    DeviceIndex rollingGroupStart(uint8_t);
+    void rollNext(void);
+#endif
+    void startPolling(uint8_t, unsigned long, bool);
+    bool pollConversion(unsigned long);
+    void learnConversion(uint8_t, unsigned long, bool);
+    uint16_t conversionWait(uint8_t);
+    uint8_t decodeResolution(const uint8_t*, const uint8_t*);
     void activateExternalPullup(void);
     void deactivateExternalPullup(void);
+    unsigned long clockNow(void);
+    void clockWait(unsigned long);
+    void clockIdle(void);
+
+    // Bus access, counted when REQUIRESBUSSTATS is set
+    uint8_t busReset(void);
+    void busSelect(const uint8_t*);
+    void busSkip(void);
+    void busWrite(uint8_t, uint8_t power = 0);
+    uint8_t busRead(void);
 
 #if REQUIRESALARMS
     uint8_t alarmSearchAddress[8];
@@ -187,6 +712,25 @@ private:
     uint8_t alarmSearchExhausted;
     AlarmHandler* _AlarmHandler;
 #endif
+
+#if REQUIRESBUSSTATS
+    BusStats busStats;
+#endif
+
+#if REQUIRESHEALTH
+    uint8_t quarantineThreshold;
+    bool admitRead(DeviceInfo*);
+    void budgetRetries(const DeviceInfo*, byte*);
+    void recordAttempt(DeviceInfo*, uint8_t);
+    void recordRead(DeviceInfo*, bool, int32_t);
+#endif
+
+#if REQUIRESSCHEDULE
+    uint8_t broadcastPercent;
+    unsigned long scheduleLead(const DeviceInfo*);
+    bool scheduleDue(DeviceInfo*, unsigned long);
+    void scheduleNext(void);
+#endif
 };
 
 #endif // DallasTemperature_h
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "DallasTemperatureGroup.h"
+
+DallasTemperatureGroup::DallasTemperatureGroup(DallasTemperature* _buses, uint8_t _busCount) {
+    buses = _buses;
+    busCount = _busCount;
+    clock = nullptr;
+    waitForConversion = true;
+    request = {};
+}
+
+void DallasTemperatureGroup::begin(void) {
+    for (uint8_t i = 0; i < busCount; i++) {
+        buses[i].begin();
+    }
+}
+
+uint8_t DallasTemperatureGroup::getBusCount(void) {
+    return busCount;
+}
+
+DallasTemperature* DallasTemperatureGroup::getBus(uint8_t index) {
+    if (index >= busCount) return nullptr;
+    return &buses[index];
+}
+
+uint16_t DallasTemperatureGroup::getDeviceCount(void) {
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < busCount; i++) {
+        count += buses[i].getDeviceCount();
+    }
+    return count;
+}
+
+// One clock for the group and all its buses, see DallasTemperature::setClock()
+void DallasTemperatureGroup::setClock(DallasTemperature::Clock* _clock) {
+    clock = _clock;
+    for (uint8_t i = 0; i < busCount; i++) {
+        buses[i].setClock(_clock);
+    }
+}
+
+void DallasTemperatureGroup::setWaitForConversion(bool flag) {
+    waitForConversion = flag;
+}
+
+bool DallasTemperatureGroup::getWaitForConversion(void) {
+    return waitForConversion;
+}
+
+// Start a conversion on every bus back to back with each bus's own
+// startConversion(), which holds a parasite bus's strong pullup until its
+// conversion is done, then wait once. A sweep of the group ends one still
+// running on a bus. result is false when no bus started.
+DallasTemperature::request_t DallasTemperatureGroup::requestTemperatures(void) {
+    request.result = false;
+    for (uint8_t i = 0; i < busCount; i++) {
+        buses[i].stopConversion();
+        if (buses[i].startConversion()) request.result = true;
+    }
+    request.timestamp = (clock != nullptr) ? clock->now() : millis();
+    
+    if (waitForConversion) {
+        blockTillConversionComplete();
+    }
+    return request;
+}
+
+// Each bus is checked against its own request: powered buses are polled,
+// parasite ones left alone until their conversion time has passed. A
+// finished bus's sweep is ended there, releasing its strong pullup, so
+// none of its devices is read before readAll().
+bool DallasTemperatureGroup::isConversionComplete(void) {
+    bool complete = true;
+    for (uint8_t i = 0; i < busCount; i++) {
+        if (buses[i].getConversionState() != DallasTemperature::CONVERSION_CONVERTING) continue;
+        if (buses[i].isConversionComplete(buses[i].getConversionRequest()))
+            buses[i].stopConversion();
+        else
+            complete = false;
+    }
+    return complete;
+}
+
+void DallasTemperatureGroup::blockTillConversionComplete(void) {
+    while (!isConversionComplete()) {
+        if (clock != nullptr)
+            clock->idle();
+        else
+            yield();
+    }
+}
+
+// Read every device of every bus into readings[], laid out bus by bus,
+// taking one device from each bus in turn. Returns the entries filled.
+// This ends sweeps still running.
+uint16_t DallasTemperatureGroup::readAll(DallasTemperature::Reading* readings, size_t count) {
+    uint16_t filled = 0;
+    DeviceIndex rounds = 0;
+    
+    for (uint8_t i = 0; i < busCount; i++) {
+        buses[i].stopConversion();
+        if (buses[i].getDeviceCount() > rounds) rounds = buses[i].getDeviceCount();
+    }
+    
+    for (DeviceIndex k = 0; k < rounds; k++) {
+        size_t base = 0;
+        for (uint8_t i = 0; i < busCount; i++) {
+            DeviceIndex devices = buses[i].getDeviceCount();
+            if (k < devices && base + k < count) {
+                buses[i].getReadingByIndex(k, &readings[base + k]);
+                filled++;
+            }
+            base += devices;
+        }
+    }
+    return filled;
+}
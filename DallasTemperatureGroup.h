@@ -0,0 +1,41 @@
+#ifndef DallasTemperatureGroup_h
+#define DallasTemperatureGroup_h
+
+#include "DallasTemperature.h"
+
+// Converts on several 1-Wire buses at once. Each bus keeps its own
+// DallasTemperature; the group starts the conversions together, waits
+// once for the slowest bus and then reads the buses interleaved, so a
+// sweep takes about one conversion time however many buses there are.
+//
+// Devices are numbered bus by bus: bus 0's devices first, then bus 1's.
+class DallasTemperatureGroup {
+public:
+    DallasTemperatureGroup(DallasTemperature*, uint8_t);
+
+    // Setup
+    void begin(void);
+    uint8_t getBusCount(void);
+    DallasTemperature* getBus(uint8_t);
+    uint16_t getDeviceCount(void);
+    void setClock(DallasTemperature::Clock*);
+
+    // Conversion Configuration
+    void setWaitForConversion(bool);
+    bool getWaitForConversion(void);
+
+    // Temperature Operations
+    DallasTemperature::request_t requestTemperatures(void);
+    bool isConversionComplete(void);
+    void blockTillConversionComplete(void);
+    uint16_t readAll(DallasTemperature::Reading*, size_t);
+
+private:
+    DallasTemperature* buses;
+    uint8_t busCount;
+    DallasTemperature::Clock* clock;
+    bool waitForConversion;
+    DallasTemperature::request_t request;
+};
+
+#endif // DallasTemperatureGroup_h
@@ -0,0 +1,52 @@
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include <DallasTemperatureGroup.h>
+
+// Conversions on all buses run at the same time, so a sweep takes one
+// conversion time instead of one per bus (compare Multibus_simple)
+
+#define MAX_READINGS 16
+
+OneWire ds18x20[] = { 3, 7 };
+DallasTemperature sensor[] = { &ds18x20[0], &ds18x20[1] };
+const int oneWireCount = sizeof(ds18x20) / sizeof(OneWire);
+DallasTemperatureGroup group(sensor, oneWireCount);
+
+DallasTemperature::Reading readings[MAX_READINGS];
+
+void setup(void) {
+  // start serial port
+  Serial.begin(9600);
+  Serial.println("Dallas Temperature Multiple Bus Group Demo");
+
+  // Start up the library on all buses
+  group.begin();
+  Serial.print("Found ");
+  Serial.print(group.getDeviceCount());
+  Serial.print(" devices on ");
+  Serial.print(oneWireCount);
+  Serial.println(" buses");
+}
+
+void loop(void) {
+  Serial.print("Requesting temperatures...");
+  unsigned long start = millis();
+  group.requestTemperatures();
+  uint16_t count = group.readAll(readings, MAX_READINGS);
+  Serial.print("DONE in ");
+  Serial.print(millis() - start);
+  Serial.println(" ms");
+
+  for (uint16_t i = 0; i < count; i++) {
+    Serial.print("Sensor ");
+    Serial.print(i);
+    Serial.print(": ");
+    if (readings[i].status == DallasTemperature::READING_OK) {
+      Serial.println(DallasTemperature::rawToCelsius(readings[i].raw));
+    } else {
+      Serial.println("no reading");
+    }
+  }
+  Serial.println();
+  delay(1000);
+}
@@ -0,0 +1,52 @@
+//
+// Sample of the non-blocking conversion engine: the loop keeps running
+// while the sensors convert, and every reading arrives through a handler.
+//
+#include <OneWire.h>
+#include <DallasTemperature.h>
+
+// Data wire is plugged into port 2 on the Arduino
+#define ONE_WIRE_BUS 2
+
+// Setup a oneWire instance to communicate with any OneWire devices (not just Maxim/Dallas temperature ICs)
+OneWire oneWire(ONE_WIRE_BUS);
+
+// Pass our oneWire reference to Dallas Temperature.
+DallasTemperature sensors(&oneWire);
+
+unsigned long loops = 0;
+
+// called by tick() for every device once its reading is in
+void newTemperature(DeviceIndex index, const uint8_t* deviceAddress, int32_t raw)
+{
+  Serial.print("Device ");
+  Serial.print(index);
+  Serial.print(": ");
+  Serial.print(DallasTemperature::rawToCelsius(raw));
+  Serial.println(" C");
+}
+
+void setup(void)
+{
+  Serial.begin(9600);
+  Serial.println("Dallas Temperature Control Library - Non-blocking Demo");
+
+  sensors.begin();
+  sensors.setTemperatureHandler(newTemperature);
+  sensors.startConversion();
+}
+
+void loop(void)
+{
+  // tick() never uses the bus for more than one transaction
+  if (sensors.tick() == DallasTemperature::CONVERSION_READY)
+  {
+    Serial.print("Loops while converting: ");
+    Serial.println(loops);
+    loops = 0;
+    sensors.startConversion();
+  }
+
+  // the rest of the application runs here
+  loops++;
+}
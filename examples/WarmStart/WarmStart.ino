@@ -0,0 +1,96 @@
+//
+// Sample of a warm start: the device table found by the first boot is kept
+// in EEPROM, so later boots only check each sensor instead of searching
+// the bus and reading every sensor's configuration.
+//
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include <EEPROM.h>
+
+// Data wire is plugged into port 2 on the Arduino
+#define ONE_WIRE_BUS 2
+
+#if defined(ESP8266) || defined(ESP32)
+// The ESP cores emulate the EEPROM in flash: it is sized by EEPROM.begin()
+// and written out by EEPROM.commit()
+#define EEPROM_SIZE 512
+#endif
+
+// Setup a oneWire instance to communicate with any OneWire devices (not just Maxim/Dallas temperature ICs)
+OneWire oneWire(ONE_WIRE_BUS);
+
+// Pass our oneWire reference to Dallas Temperature.
+DallasTemperature sensors(&oneWire);
+
+// Keeps the device table at the start of the EEPROM
+class EepromStorage : public DallasTemperature::Storage
+{
+public:
+  bool read(uint16_t offset, uint8_t* data, uint16_t length)
+  {
+    if (offset + length > EEPROM.length()) return false;
+    for (uint16_t i = 0; i < length; i++) data[i] = EEPROM.read(offset + i);
+    return true;
+  }
+
+  bool write(uint16_t offset, const uint8_t* data, uint16_t length)
+  {
+    if (offset + length > EEPROM.length()) return false;
+#if defined(ESP8266) || defined(ESP32)
+    for (uint16_t i = 0; i < length; i++) EEPROM.write(offset + i, data[i]);
+    return EEPROM.commit();
+#else
+    for (uint16_t i = 0; i < length; i++) EEPROM.update(offset + i, data[i]);
+    return true;
+#endif
+  }
+};
+
+EepromStorage storage;
+
+void setup(void)
+{
+  Serial.begin(9600);
+  Serial.println("Dallas Temperature Control Library - Warm Start Demo");
+#if defined(ESP8266) || defined(ESP32)
+  EEPROM.begin(EEPROM_SIZE);
+#endif
+
+  unsigned long start = millis();
+  if (sensors.begin(&storage))
+  {
+    Serial.print("Restored the saved device table");
+  }
+  else
+  {
+    // first boot or the bus has changed: save what the search found
+    sensors.saveDeviceTable(&storage);
+    Serial.print("Searched the bus and saved the device table");
+  }
+  Serial.print(" in ");
+  Serial.print(millis() - start);
+  Serial.println(" ms");
+
+  Serial.print("Found ");
+  Serial.print(sensors.getDeviceCount());
+  Serial.println(" devices.");
+}
+
+void loop(void)
+{
+  sensors.requestTemperatures();
+  for (uint8_t i = 0; i < sensors.getDeviceCount(); i++)
+  {
+    Serial.print("Device ");
+    Serial.print(i);
+    Serial.print(": ");
+    Serial.println(sensors.getTempCByIndex(i));
+  }
+
+  // sensors added while running are picked up, and the table saved again
+  if (sensors.scanForChanges() > 0)
+  {
+    sensors.saveDeviceTable(&storage);
+  }
+  delay(1000);
+}
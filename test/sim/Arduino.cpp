@@ -0,0 +1,37 @@
+#include "Arduino.h"
+
+uint64_t simMicros = 0;
+
+unsigned long millis(void) {
+    return (unsigned long)(simMicros / 1000);
+}
+
+unsigned long micros(void) {
+    return (unsigned long)simMicros;
+}
+
+void delay(unsigned long ms) {
+    simAdvance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    simAdvance(us);
+}
+
+// A busy loop calling yield() must still see time pass
+void yield(void) {
+    simAdvance(1);
+}
+
+static uint8_t pinLevels[256];
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    pinLevels[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+    return pinLevels[pin];
+}
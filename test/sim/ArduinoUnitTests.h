@@ -0,0 +1,110 @@
+//    FILE: ArduinoUnitTests.h
+// PURPOSE: host-side stand-in for the arduino_ci unit test macros, so the
+//          simulator tests read exactly like the tests in test/.
+
+#ifndef ArduinoUnitTests_h
+#define ArduinoUnitTests_h
+
+#include <stdio.h>
+#include <math.h>
+
+namespace ArduinoUnitTestsHost {
+
+typedef void (*TestFunction)(void);
+
+struct Test {
+    const char* name;
+    TestFunction fn;
+    Test* next;
+};
+
+struct Registry {
+    Test* first;
+    Test* last;
+    TestFunction setup;
+    TestFunction teardown;
+    int failures;
+    int assertions;
+    bool testFailed;
+};
+
+inline Registry& registry() {
+    static Registry r = { nullptr, nullptr, nullptr, nullptr, 0, 0, false };
+    return r;
+}
+
+struct Registrar {
+    Registrar(Test* t) {
+        Registry& r = registry();
+        if (r.last) r.last->next = t;
+        else r.first = t;
+        r.last = t;
+    }
+};
+
+struct Hook {
+    Hook(TestFunction fn, bool isSetup) {
+        if (isSetup) registry().setup = fn;
+        else registry().teardown = fn;
+    }
+};
+
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    Registry& r = registry();
+    r.assertions++;
+    if (!ok) {
+        r.testFailed = true;
+        fprintf(stderr, "  FAIL %s:%d: %s\n", file, line, expr);
+    }
+}
+
+inline int run() {
+    Registry& r = registry();
+    int tests = 0;
+    for (Test* t = r.first; t; t = t->next) {
+        tests++;
+        r.testFailed = false;
+        if (r.setup) r.setup();
+        t->fn();
+        if (r.teardown) r.teardown();
+        fprintf(stderr, "%s %s\n", r.testFailed ? "not ok" : "ok", t->name);
+        if (r.testFailed) r.failures++;
+    }
+    fprintf(stderr, "%d tests, %d assertions, %d failed\n", tests, r.assertions, r.failures);
+    return r.failures ? 1 : 0;
+}
+
+} // namespace ArduinoUnitTestsHost
+
+#define unittest(name)                                                          \
+    static void unittest_##name(void);                                          \
+    static ArduinoUnitTestsHost::Test unittest_t_##name = { #name, unittest_##name, nullptr }; \
+    static ArduinoUnitTestsHost::Registrar unittest_r_##name(&unittest_t_##name); \
+    static void unittest_##name(void)
+
+#define unittest_setup()                                                        \
+    static void unittest_setup_fn(void);                                        \
+    static ArduinoUnitTestsHost::Hook unittest_setup_hook(unittest_setup_fn, true); \
+    static void unittest_setup_fn(void)
+
+#define unittest_teardown()                                                     \
+    static void unittest_teardown_fn(void);                                     \
+    static ArduinoUnitTestsHost::Hook unittest_teardown_hook(unittest_teardown_fn, false); \
+    static void unittest_teardown_fn(void)
+
+#define unittest_main() \
+    int main(void) { return ArduinoUnitTestsHost::run(); }
+
+#define UT_CHECK(ok, expr) ArduinoUnitTestsHost::check((ok), (expr), __FILE__, __LINE__)
+
+#define assertEqual(a, b)          UT_CHECK((a) == (b), #a " == " #b)
+#define assertNotEqual(a, b)       UT_CHECK((a) != (b), #a " != " #b)
+#define assertLess(a, b)           UT_CHECK((a) < (b), #a " < " #b)
+#define assertMore(a, b)           UT_CHECK((a) > (b), #a " > " #b)
+#define assertLessOrEqual(a, b)    UT_CHECK((a) <= (b), #a " <= " #b)
+#define assertMoreOrEqual(a, b)    UT_CHECK((a) >= (b), #a " >= " #b)
+#define assertTrue(a)              UT_CHECK((a), #a)
+#define assertFalse(a)             UT_CHECK(!(a), "!" #a)
+#define assertEqualFloat(a, b, e)  UT_CHECK(fabs((double)(a) - (double)(b)) <= (e), #a " ~= " #b)
+
+#endif // ArduinoUnitTests_h
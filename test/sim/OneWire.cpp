@@ -0,0 +1,588 @@
+#include "OneWire.h"
+
+// ROM commands
+#define SIM_READROM   0x33
+#define SIM_MATCHROM  0x55
+#define SIM_SKIPROM   0xCC
+#define SIM_SEARCHROM 0xF0
+#define SIM_ALARMROM  0xEC
+
+// Function commands
+#define SIM_CONVERT   0x44
+#define SIM_READSP    0xBE
+#define SIM_WRITESP   0x4E
+#define SIM_COPYSP    0x48
+#define SIM_RECALLSP  0xB8
+#define SIM_READPWR   0xB4
+
+SimDevice::SimDevice(uint8_t family, uint64_t serial)
+    : conversions(0), eepromWrites(0), scratchpadReads(0), scratchpadWrites(0),
+      temperature(20.0f), parasite(false), connected(true), alarmFlag(false),
+      conversionPercent(SIM_CONVERSION_PERCENT), corruptCount(0), bus(nullptr),
+      phase(INACTIVE), bitCount(0), shift(0), searchBit(0), searchStep(0),
+      rxIndex(0), txLength(0), txBit(0), busyKind(0), busyUntil(0) {
+    rom[0] = family;
+    for (uint8_t i = 1; i < 7; i++) {
+        rom[i] = (uint8_t)(serial >> (8 * (i - 1)));
+    }
+    rom[7] = OneWire::crc8(rom, 7);
+    memset(scratch, 0xFF, sizeof(scratch));
+    memset(nv, 0, sizeof(nv));
+}
+
+void SimDevice::updateCrc() {
+    scratch[8] = OneWire::crc8(scratch, 8);
+}
+
+void SimDevice::transmit(const uint8_t* data, uint8_t length) {
+    memcpy(tx, data, length);
+    txLength = length;
+    txBit = 0;
+    phase = TX;
+}
+
+void SimDevice::startBusy(uint8_t kind, uint32_t us, uint64_t now) {
+    busyKind = kind;
+    busyUntil = now + us;
+    if (parasite && bus) bus->notifyParasiteBusy();
+}
+
+void SimDevice::finishBusy() {
+    if (busyKind == CONVERT) {
+        latchTemperature();
+        conversions++;
+    } else if (busyKind == COPY && parasite) {
+        copy();
+        eepromWrites++;
+    }
+    busyKind = 0;
+    busyUntil = 0;
+}
+
+void SimDevice::settle(uint64_t now) {
+    if (busyUntil == 0 || now < busyUntil) return;
+    if (!parasite || (bus && bus->pullup)) finishBusy();
+}
+
+// Parasite devices draw their operating current from the strong pullup;
+// any bus activity before the operation finishes starves them.
+void SimDevice::powerCheck(uint64_t now, bool pullupHeld) {
+    if (!parasite || busyUntil == 0) return;
+    if (pullupHeld && now >= busyUntil) {
+        finishBusy();
+    } else {
+        busyKind = 0;
+        busyUntil = 0;
+    }
+}
+
+bool SimDevice::onReset(uint64_t now) {
+    settle(now);
+    if (!connected) {
+        phase = INACTIVE;
+        return false;
+    }
+    phase = ROM_CMD;
+    bitCount = 0;
+    shift = 0;
+    return true;
+}
+
+void SimDevice::receiveBit(uint8_t bit, uint64_t now) {
+    switch (phase) {
+        case ROM_CMD:
+            shift |= bit << bitCount;
+            if (++bitCount < 8) break;
+            bitCount = 0;
+            switch (shift) {
+                case SIM_READROM:  transmit(rom, 8); break;
+                case SIM_MATCHROM: phase = MATCH; break;
+                case SIM_SKIPROM:  phase = FUNC_CMD; shift = 0; break;
+                case SIM_ALARMROM:
+                    if (!alarmFlag) { phase = INACTIVE; break; }
+                    // fall through
+                case SIM_SEARCHROM:
+                    phase = SEARCH;
+                    searchBit = 0;
+                    searchStep = 0;
+                    break;
+                default: phase = INACTIVE; break;
+            }
+            break;
+        case MATCH:
+            if (bit != romBit(bitCount)) {
+                phase = INACTIVE;
+            } else if (++bitCount == 64) {
+                phase = FUNC_CMD;
+                bitCount = 0;
+                shift = 0;
+            }
+            break;
+        case SEARCH:
+            if (searchStep != 2) break;
+            if (bit != romBit(searchBit)) {
+                phase = INACTIVE;
+            } else if (++searchBit == 64) {
+                phase = FUNC_CMD;
+                bitCount = 0;
+                shift = 0;
+            } else {
+                searchStep = 0;
+            }
+            break;
+        case FUNC_CMD:
+            shift |= bit << bitCount;
+            if (++bitCount == 8) {
+                bitCount = 0;
+                onFunction(shift, now);
+            }
+            break;
+        case RX:
+            shift |= bit << bitCount;
+            if (++bitCount == 8) {
+                storeByte(rxIndex++, shift);
+                updateCrc();
+                bitCount = 0;
+                shift = 0;
+                if (rxIndex == writableBytes()) phase = INACTIVE;
+            }
+            break;
+        case TX:
+            txBit++;
+            break;
+        default:
+            break;
+    }
+}
+
+void SimDevice::onFunction(uint8_t cmd, uint64_t now) {
+    switch (cmd) {
+        case SIM_CONVERT:
+            phase = CONVERT;
+            startBusy(CONVERT, (uint32_t)((uint64_t)conversionMicros() * conversionPercent / 100), now);
+            break;
+        case SIM_READSP: {
+            settle(now);
+            scratchpadReads++;
+            uint8_t data[9];
+            memcpy(data, scratch, 9);
+            if (corruptCount) {
+                corruptCount--;
+                data[0] ^= 0x01;
+            }
+            transmit(data, 9);
+            break;
+        }
+        case SIM_WRITESP:
+            if (!writableBytes()) { phase = INACTIVE; break; }
+            scratchpadWrites++;
+            phase = RX;
+            rxIndex = 0;
+            shift = 0;
+            break;
+        case SIM_COPYSP:
+            if (!writableBytes()) { phase = INACTIVE; break; }
+            phase = COPY;
+            if (!parasite) {
+                copy();
+                eepromWrites++;
+            }
+            startBusy(COPY, SIM_COPY_US, now);
+            break;
+        case SIM_RECALLSP:
+            if (!writableBytes()) { phase = INACTIVE; break; }
+            recall();
+            updateCrc();
+            phase = RECALL;
+            break;
+        case SIM_READPWR:
+            phase = READ_POWER;
+            bitCount = 0;
+            break;
+        default:
+            phase = INACTIVE;
+            break;
+    }
+}
+
+uint8_t SimDevice::onReadSlot(uint64_t now) {
+    switch (phase) {
+        case TX: {
+            uint8_t bit = 1;
+            if (txBit < txLength * 8) bit = (tx[txBit >> 3] >> (txBit & 7)) & 1;
+            txBit++;
+            return bit;
+        }
+        case SEARCH:
+            if (searchStep == 0) { searchStep = 1; return romBit(searchBit); }
+            if (searchStep == 1) { searchStep = 2; return !romBit(searchBit); }
+            receiveBit(1, now);
+            return 1;
+        case CONVERT:
+        case COPY:
+            settle(now);
+            if (parasite) return 1;
+            return busyUntil == 0 ? 1 : 0;
+        case READ_POWER:
+            if (bitCount == 0) {
+                bitCount = 1;
+                return parasite ? 0 : 1;
+            }
+            return 1;
+        case ROM_CMD:
+        case MATCH:
+        case FUNC_CMD:
+        case RX:
+            // a read slot looks like a written 1 to the device
+            receiveBit(1, now);
+            return 1;
+        default:
+            return 1;
+    }
+}
+
+void SimDevice::onWriteSlot(uint8_t bit, uint64_t now) {
+    receiveBit(bit, now);
+}
+
+// DS18B20 family
+
+SimDS18B20::SimDS18B20(uint64_t serial, uint8_t family) : SimDevice(family, serial) {
+    nv[0] = 75;
+    nv[1] = 70;
+    nv[2] = 0x7F;
+    scratch[0] = 0x50;  // 85 C power-on value
+    scratch[1] = 0x05;
+    scratch[2] = nv[0];
+    scratch[3] = nv[1];
+    scratch[4] = nv[2];
+    scratch[5] = 0xFF;
+    scratch[6] = 0x0C;
+    scratch[7] = 0x10;
+    updateCrc();
+}
+
+uint8_t SimDS18B20::resolution() const {
+    return ((scratch[4] >> 5) & 0x03) + 9;
+}
+
+uint32_t SimDS18B20::conversionMicros() const {
+    return 93750UL << (resolution() - 9);
+}
+
+void SimDS18B20::latchTemperature() {
+    float t = temperature;
+    if (t > 125.0f) t = 125.0f;
+    if (t < -55.0f) t = -55.0f;
+    int16_t raw = (int16_t)floorf(t * 16.0f);
+    raw &= ~((1 << (12 - resolution())) - 1);
+    scratch[0] = raw & 0xFF;
+    scratch[1] = (raw >> 8) & 0xFF;
+    updateCrc();
+    int8_t whole = raw >> 4;
+    alarmFlag = whole <= (int8_t)scratch[3] || whole >= (int8_t)scratch[2];
+}
+
+void SimDS18B20::storeByte(uint8_t index, uint8_t value) {
+    if (index < 2) scratch[2 + index] = value;
+    else scratch[4] = (value & 0x60) | 0x1F;
+}
+
+void SimDS18B20::recall() {
+    memcpy(&scratch[2], nv, 3);
+}
+
+void SimDS18B20::copy() {
+    memcpy(nv, &scratch[2], 3);
+}
+
+// DS18S20
+
+SimDS18S20::SimDS18S20(uint64_t serial) : SimDevice(0x10, serial) {
+    nv[0] = 75;
+    nv[1] = 70;
+    scratch[0] = 0xAA;  // 85 C power-on value
+    scratch[1] = 0x00;
+    scratch[2] = nv[0];
+    scratch[3] = nv[1];
+    scratch[4] = 0xFF;
+    scratch[5] = 0xFF;
+    scratch[6] = 0x0C;
+    scratch[7] = 0x10;
+    updateCrc();
+}
+
+void SimDS18S20::latchTemperature() {
+    float t = temperature;
+    if (t > 125.0f) t = 125.0f;
+    if (t < -55.0f) t = -55.0f;
+    int16_t reg = (int16_t)floorf(t * 2.0f);
+    int16_t whole = reg >> 1;
+    int16_t remain = 16 - (int16_t)lroundf((t - whole + 0.25f) * 16.0f);
+    if (remain < 0) remain = 0;
+    if (remain > 16) remain = 16;
+    scratch[0] = reg & 0xFF;
+    scratch[1] = reg < 0 ? 0xFF : 0x00;
+    scratch[6] = (uint8_t)remain;
+    updateCrc();
+    alarmFlag = whole <= (int8_t)scratch[3] || whole >= (int8_t)scratch[2];
+}
+
+void SimDS18S20::storeByte(uint8_t index, uint8_t value) {
+    scratch[2 + index] = value;
+}
+
+void SimDS18S20::recall() {
+    memcpy(&scratch[2], nv, 2);
+}
+
+void SimDS18S20::copy() {
+    memcpy(nv, &scratch[2], 2);
+}
+
+// MAX31850
+
+SimMAX31850::SimMAX31850(uint64_t serial, uint8_t addressPins) : SimDevice(0x3B, serial), fault(NONE) {
+    scratch[0] = 0x00;
+    scratch[1] = 0x00;
+    scratch[2] = 0x00;
+    scratch[3] = 0x19;  // 25 C cold junction
+    scratch[4] = 0xF0 | (addressPins & 0x0F);
+    updateCrc();
+}
+
+void SimMAX31850::latchTemperature() {
+    int16_t raw = (int16_t)floorf(temperature * 4.0f);
+    uint16_t reg = (uint16_t)(raw << 2);
+    if (fault) reg |= 1;
+    scratch[0] = reg & 0xFF;
+    scratch[1] = reg >> 8;
+    scratch[2] = fault & 0x07;
+    updateCrc();
+}
+
+// Bus
+
+OneWire::OneWire(uint8_t pin) : pin(pin), pullup(false), parasiteBusy(false) {
+    memset(&stats, 0, sizeof(stats));
+    reset_search();
+}
+
+void OneWire::attach(SimDevice* device) {
+    device->bus = this;
+    devices.push_back(device);
+}
+
+void OneWire::detach(SimDevice* device) {
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i] == device) {
+            devices.erase(devices.begin() + i);
+            break;
+        }
+    }
+    for (size_t i = 0; i < active.size(); i++) {
+        if (active[i] == device) {
+            active.erase(active.begin() + i);
+            break;
+        }
+    }
+    device->bus = nullptr;
+}
+
+void OneWire::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void OneWire::beginSlot() {
+    if (parasiteBusy) {
+        bool busy = false;
+        for (size_t i = 0; i < devices.size(); i++) {
+            devices[i]->powerCheck(simMicros, pullup);
+            busy = busy || devices[i]->parasiteBusy();
+        }
+        parasiteBusy = busy;
+    }
+    pullup = false;
+}
+
+void OneWire::dropInactive() {
+    size_t n = 0;
+    for (size_t i = 0; i < active.size(); i++) {
+        if (active[i]->isActive()) active[n++] = active[i];
+    }
+    active.resize(n);
+}
+
+uint8_t OneWire::reset(void) {
+    beginSlot();
+    stats.resets++;
+    active.clear();
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i]->onReset(simMicros)) active.push_back(devices[i]);
+    }
+    simAdvance(SIM_RESET_US);
+    stats.busMicros += SIM_RESET_US;
+    if (active.empty()) {
+        stats.presenceFailures++;
+        return 0;
+    }
+    return 1;
+}
+
+void OneWire::write_bit(uint8_t v) {
+    beginSlot();
+    v = v ? 1 : 0;
+    stats.bitsWritten++;
+    for (size_t i = 0; i < active.size(); i++) {
+        active[i]->onWriteSlot(v, simMicros);
+    }
+    dropInactive();
+    uint32_t us = v ? SIM_WRITE1_US : SIM_WRITE0_US;
+    simAdvance(us);
+    stats.busMicros += us;
+}
+
+uint8_t OneWire::read_bit(void) {
+    beginSlot();
+    stats.bitsRead++;
+    uint8_t r = 1;
+    for (size_t i = 0; i < active.size(); i++) {
+        r &= active[i]->onReadSlot(simMicros);
+    }
+    dropInactive();
+    simAdvance(SIM_READ_US);
+    stats.busMicros += SIM_READ_US;
+    return r;
+}
+
+void OneWire::write(uint8_t v, uint8_t power) {
+    for (uint8_t mask = 0x01; mask; mask <<= 1) {
+        write_bit(v & mask);
+    }
+    stats.bytesWritten++;
+    pullup = power != 0;
+}
+
+void OneWire::write_bytes(const uint8_t* buf, uint16_t count, bool power) {
+    for (uint16_t i = 0; i < count; i++) write(buf[i]);
+    pullup = power;
+}
+
+uint8_t OneWire::read() {
+    uint8_t r = 0;
+    for (uint8_t mask = 0x01; mask; mask <<= 1) {
+        if (read_bit()) r |= mask;
+    }
+    stats.bytesRead++;
+    return r;
+}
+
+void OneWire::read_bytes(uint8_t* buf, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) buf[i] = read();
+}
+
+void OneWire::select(const uint8_t rom[8]) {
+    write(SIM_MATCHROM);
+    for (uint8_t i = 0; i < 8; i++) write(rom[i]);
+}
+
+void OneWire::skip() {
+    write(SIM_SKIPROM);
+}
+
+void OneWire::depower() {
+    beginSlot();
+}
+
+void OneWire::reset_search() {
+    LastDiscrepancy = 0;
+    LastDeviceFlag = false;
+    LastFamilyDiscrepancy = 0;
+    memset(ROM_NO, 0, sizeof(ROM_NO));
+}
+
+void OneWire::target_search(uint8_t family_code) {
+    ROM_NO[0] = family_code;
+    for (uint8_t i = 1; i < 8; i++) ROM_NO[i] = 0;
+    LastDiscrepancy = 64;
+    LastFamilyDiscrepancy = 0;
+    LastDeviceFlag = false;
+}
+
+// Maxim AN187 search, as implemented by the OneWire library
+bool OneWire::search(uint8_t* newAddr, bool search_mode) {
+    uint8_t id_bit_number = 1;
+    uint8_t last_zero = 0;
+    uint8_t rom_byte_number = 0;
+    uint8_t rom_byte_mask = 1;
+    bool search_result = false;
+
+    if (!LastDeviceFlag) {
+        if (!reset()) {
+            reset_search();
+            return false;
+        }
+        write(search_mode ? SIM_SEARCHROM : SIM_ALARMROM);
+
+        do {
+            uint8_t id_bit = read_bit();
+            uint8_t cmp_id_bit = read_bit();
+            uint8_t direction;
+
+            if (id_bit && cmp_id_bit) break;
+
+            if (id_bit != cmp_id_bit) {
+                direction = id_bit;
+            } else {
+                if (id_bit_number < LastDiscrepancy)
+                    direction = (ROM_NO[rom_byte_number] & rom_byte_mask) > 0;
+                else
+                    direction = (id_bit_number == LastDiscrepancy);
+                if (direction == 0) {
+                    last_zero = id_bit_number;
+                    if (last_zero < 9) LastFamilyDiscrepancy = last_zero;
+                }
+            }
+
+            if (direction) ROM_NO[rom_byte_number] |= rom_byte_mask;
+            else ROM_NO[rom_byte_number] &= ~rom_byte_mask;
+            write_bit(direction);
+
+            id_bit_number++;
+            rom_byte_mask <<= 1;
+            if (rom_byte_mask == 0) {
+                rom_byte_number++;
+                rom_byte_mask = 1;
+            }
+        } while (rom_byte_number < 8);
+
+        if (id_bit_number == 65) {
+            LastDiscrepancy = last_zero;
+            if (LastDiscrepancy == 0) LastDeviceFlag = true;
+            search_result = true;
+        }
+    }
+
+    if (!search_result || !ROM_NO[0]) {
+        LastDiscrepancy = 0;
+        LastDeviceFlag = false;
+        LastFamilyDiscrepancy = 0;
+        return false;
+    }
+    memcpy(newAddr, ROM_NO, 8);
+    return true;
+}
+
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--) {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
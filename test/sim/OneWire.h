@@ -0,0 +1,242 @@
+//    FILE: OneWire.h
+// PURPOSE: host-side simulated 1-Wire bus, API compatible with the
+//          OneWire library, for testing and benchmarking DallasTemperature.
+//
+// The bus works at the time slot level: every reset, read slot and write
+// slot is offered to the attached devices, which run their own ROM and
+// function command state machines. Search collisions are therefore the
+// wired-AND of the participating devices, exactly as on a real bus.
+// Each slot advances the simulated clock (see Arduino.h) by the time the
+// OneWire library spends on it at standard speed, and is counted in stats.
+
+#ifndef OneWire_h
+#define OneWire_h
+
+#include <Arduino.h>
+#include <vector>
+
+// Standard speed slot durations used by the OneWire library (microseconds)
+#define SIM_RESET_US  960
+#define SIM_WRITE1_US 65
+#define SIM_WRITE0_US 70
+#define SIM_READ_US   66
+
+// Scratchpad EEPROM copy time (datasheet maximum, microseconds)
+#define SIM_COPY_US   10000
+
+// Real devices convert well inside the datasheet maximum; a 12 bit
+// DS18B20 typically takes about 600 ms of the 750 ms allowed
+#define SIM_CONVERSION_PERCENT 80
+
+struct SimBusStats {
+    uint32_t resets;
+    uint32_t presenceFailures;
+    uint32_t bitsWritten;
+    uint32_t bitsRead;
+    uint32_t bytesWritten;
+    uint32_t bytesRead;
+    uint64_t busMicros;
+};
+
+class OneWire;
+
+class SimDevice {
+public:
+    SimDevice(uint8_t family, uint64_t serial);
+    virtual ~SimDevice() {}
+
+    const uint8_t* address() const { return rom; }
+    uint8_t family() const { return rom[0]; }
+
+    // Environment
+    void setTemperature(float celsius) { temperature = celsius; }
+    float getTemperature() const { return temperature; }
+    void setParasite(bool flag) { parasite = flag; }
+    bool isParasite() const { return parasite; }
+    void setConnected(bool flag) { connected = flag; }
+    bool isConnected() const { return connected; }
+    // Actual conversion time as a percentage of the datasheet maximum
+    void setConversionPercent(uint8_t percent) { conversionPercent = percent; }
+    // Flip a bit in the next n scratchpad reads, leaving the CRC stale
+    void corruptReads(uint16_t n) { corruptCount = n; }
+
+    // Inspection
+    const uint8_t* scratchpad() { settle(simMicros); return scratch; }
+    const uint8_t* eeprom() const { return nv; }
+    uint32_t conversions;
+    uint32_t eepromWrites;
+    uint32_t scratchpadReads;
+    uint32_t scratchpadWrites;
+
+    // Bus side, driven by OneWire
+    bool onReset(uint64_t now);
+    uint8_t onReadSlot(uint64_t now);
+    void onWriteSlot(uint8_t bit, uint64_t now);
+    bool isActive() const { return phase != INACTIVE; }
+    void powerCheck(uint64_t now, bool pullupHeld);
+    bool parasiteBusy() const { return parasite && busyUntil != 0; }
+
+protected:
+    enum Phase {
+        INACTIVE, ROM_CMD, MATCH, SEARCH, FUNC_CMD,
+        TX, RX, CONVERT, COPY, RECALL, READ_POWER
+    };
+
+    uint8_t rom[8];
+    uint8_t scratch[9];
+    uint8_t nv[3];
+    float temperature;
+    bool parasite;
+    bool connected;
+    bool alarmFlag;
+    uint8_t conversionPercent;
+    uint16_t corruptCount;
+
+    // Called when a function command byte has been received
+    virtual void onFunction(uint8_t cmd, uint64_t now);
+    // Latch the current temperature into the scratchpad
+    virtual void latchTemperature() {}
+    // Store a received WRITESCRATCH byte
+    virtual void storeByte(uint8_t index, uint8_t value) { (void)index; (void)value; }
+    virtual uint8_t writableBytes() const { return 0; }
+    virtual uint32_t conversionMicros() const { return 750000; }
+    virtual void recall() {}
+    virtual void copy() {}
+
+    void updateCrc();
+    void transmit(const uint8_t* data, uint8_t length);
+    void settle(uint64_t now);
+    void finishBusy();
+    void deactivate() { phase = INACTIVE; }
+
+    OneWire* bus;
+    friend class OneWire;
+
+private:
+    uint8_t phase;
+    uint8_t bitCount;
+    uint8_t shift;
+    uint8_t searchBit;
+    uint8_t searchStep;
+    uint8_t rxIndex;
+    uint8_t tx[9];
+    uint8_t txLength;
+    uint8_t txBit;
+    uint8_t busyKind;
+    uint64_t busyUntil;
+
+    uint8_t romBit(uint8_t i) const { return (rom[i >> 3] >> (i & 7)) & 1; }
+    void receiveBit(uint8_t bit, uint64_t now);
+    void startBusy(uint8_t kind, uint32_t us, uint64_t now);
+};
+
+// DS18B20 and the devices sharing its scratchpad layout
+class SimDS18B20 : public SimDevice {
+public:
+    SimDS18B20(uint64_t serial, uint8_t family = 0x28);
+    uint8_t resolution() const;
+protected:
+    void latchTemperature();
+    void storeByte(uint8_t index, uint8_t value);
+    uint8_t writableBytes() const { return 3; }
+    uint32_t conversionMicros() const;
+    void recall();
+    void copy();
+};
+
+class SimDS1822 : public SimDS18B20 {
+public:
+    SimDS1822(uint64_t serial) : SimDS18B20(serial, 0x22) {}
+};
+
+class SimDS1825 : public SimDS18B20 {
+public:
+    SimDS1825(uint64_t serial) : SimDS18B20(serial, 0x3B) {}
+};
+
+class SimDS28EA00 : public SimDS18B20 {
+public:
+    SimDS28EA00(uint64_t serial) : SimDS18B20(serial, 0x42) {}
+};
+
+// DS18S20 / DS1820: 9 bit register plus COUNT_REMAIN, no configuration byte
+class SimDS18S20 : public SimDevice {
+public:
+    SimDS18S20(uint64_t serial);
+protected:
+    void latchTemperature();
+    void storeByte(uint8_t index, uint8_t value);
+    uint8_t writableBytes() const { return 2; }
+    void recall();
+    void copy();
+};
+
+// MAX31850 thermocouple interface, shares family 0x3B with the DS1825
+class SimMAX31850 : public SimDevice {
+public:
+    SimMAX31850(uint64_t serial, uint8_t addressPins = 0);
+    enum Fault { NONE = 0, OPEN = 1, SHORT_GND = 2, SHORT_VDD = 4 };
+    void setFault(uint8_t f) { fault = f; }
+protected:
+    uint8_t fault;
+    void latchTemperature();
+    uint32_t conversionMicros() const { return 100000; }
+};
+
+// A device with a valid ROM that is not a thermometer (e.g. DS2413)
+class SimSwitch : public SimDevice {
+public:
+    SimSwitch(uint64_t serial, uint8_t family = 0x3A) : SimDevice(family, serial), functions(0) {}
+    uint32_t functions;   // function commands received, addressed or not
+protected:
+    void onFunction(uint8_t, uint64_t) { functions++; deactivate(); }
+};
+
+class OneWire {
+public:
+    OneWire(uint8_t pin = 0);
+    void begin(uint8_t pin) { this->pin = pin; }
+
+    // OneWire API
+    uint8_t reset(void);
+    void select(const uint8_t rom[8]);
+    void skip(void);
+    void write(uint8_t v, uint8_t power = 0);
+    void write_bytes(const uint8_t* buf, uint16_t count, bool power = 0);
+    uint8_t read(void);
+    void read_bytes(uint8_t* buf, uint16_t count);
+    void write_bit(uint8_t v);
+    uint8_t read_bit(void);
+    void depower(void);
+    void reset_search();
+    void target_search(uint8_t family_code);
+    bool search(uint8_t* newAddr, bool search_mode = true);
+    static uint8_t crc8(const uint8_t* addr, uint8_t len);
+
+    // Simulator
+    void attach(SimDevice* device);
+    void detach(SimDevice* device);
+    size_t deviceCount() const { return devices.size(); }
+    SimBusStats stats;
+    void resetStats();
+    void notifyParasiteBusy() { parasiteBusy = true; }
+
+private:
+    uint8_t pin;
+    bool pullup;
+    bool parasiteBusy;
+    std::vector<SimDevice*> devices;
+    std::vector<SimDevice*> active;
+
+    uint8_t ROM_NO[8];
+    uint8_t LastDiscrepancy;
+    uint8_t LastFamilyDiscrepancy;
+    bool LastDeviceFlag;
+
+    void beginSlot();
+    void dropInactive();
+
+    friend class SimDevice;
+};
+
+#endif // OneWire_h
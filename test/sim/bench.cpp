@@ -0,0 +1,210 @@
+//    FILE: bench.cpp
+// PURPOSE: bus cost of the public DallasTemperature API against growing
+//          numbers of simulated devices.
+//
+// Every case runs once on a freshly enumerated bus and reports the resets,
+// bytes and slots it put on the wire, the modelled slot time and the total
+// simulated time including conversion waits. Output is one row per case and
+// device count, CSV by default or JSON with --json, so two library versions
+// can be diffed directly. The sweep cases give the library a table holding
+// every device; their cost per device stays flat up to the largest bus.
+//
+//   make bench
+//   make bench BENCH_ARGS=--json
+
+#include <Arduino.h>
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const uint16_t deviceCounts[] = { 1, 8, 32, 128, 255, 512 };
+
+// Device table storage in RAM, for the warm start case
+class MemoryStorage : public DallasTemperature::Storage {
+public:
+    bool read(uint16_t offset, uint8_t* data, uint16_t length) {
+        if (offset + length > sizeof(bytes)) return false;
+        memcpy(data, bytes + offset, length);
+        return true;
+    }
+    bool write(uint16_t offset, const uint8_t* data, uint16_t length) {
+        if (offset + length > sizeof(bytes)) return false;
+        memcpy(bytes + offset, data, length);
+        return true;
+    }
+    uint8_t bytes[4096];
+};
+
+struct Bench {
+    OneWire oneWire;
+    std::vector<SimDevice*> devices;
+    DallasTemperature sensors;
+    DeviceAddress last;
+    MemoryStorage storage;
+    std::vector<DallasTemperature::DeviceInfo> table;
+
+    Bench(uint16_t count) : oneWire(2), sensors(&oneWire), table(count) {
+        for (uint16_t i = 0; i < count; i++) {
+            SimDS18B20* device = new SimDS18B20((i + 1) * 0x9E3779B97F4Aull & 0xFFFFFFFFFFFFull);
+            device->setTemperature(20.0f + i / 16.0f);
+            devices.push_back(device);
+            oneWire.attach(device);
+        }
+    }
+    ~Bench() {
+        for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+    }
+    DeviceIndex count() const { return (DeviceIndex)devices.size(); }
+};
+
+static void noAlarm(const uint8_t*) {}
+
+// Setup, run outside the measurement
+static void enumerate(Bench& b) {
+    b.sensors.begin();
+    b.sensors.getAddress(b.last, b.count() - 1);
+}
+static void none(Bench&) {}
+static void enumerateSaved(Bench& b) {
+    enumerate(b);
+    b.sensors.saveDeviceTable(&b.storage);
+}
+static void enumerateNoWait(Bench& b) {
+    enumerate(b);
+    b.sensors.setWaitForConversion(false);
+}
+static void enumerateConverted(Bench& b) {
+    enumerate(b);
+    b.sensors.requestTemperatures();
+}
+static void enumerateConvertedFast(Bench& b) {
+    enumerateConverted(b);
+    b.sensors.setReadMode(DallasTemperature::READ_FAST);
+}
+static void enumerateConvertedTable(Bench& b) {
+    b.sensors.setDeviceTable(b.table.data(), b.count());
+    enumerateConverted(b);
+}
+static void enumerateOneAlarm(Bench& b) {
+    enumerate(b);
+    b.sensors.setAlarmHandler(noAlarm);
+    b.sensors.setHighAlarmTemp(b.last, 10);
+    b.sensors.requestTemperatures();
+}
+
+// Measured operations
+static void runBegin(Bench& b) { b.sensors.begin(); }
+static void runBeginStorage(Bench& b) { b.sensors.begin(&b.storage); }
+static void runRescan(Bench& b) { b.sensors.rescan(); }
+static void runVerifyDeviceCount(Bench& b) { b.sensors.verifyDeviceCount(); }
+static void runScanForChanges(Bench& b) { b.sensors.scanForChanges(); }
+static void runRequestTemperatures(Bench& b) { b.sensors.requestTemperatures(); }
+static void runRequestByIndexLast(Bench& b) { b.sensors.requestTemperaturesByIndex(b.count() - 1); }
+static void runGetTempCByIndexFirst(Bench& b) { b.sensors.getTempCByIndex(0); }
+static void runGetTempCByIndexLast(Bench& b) { b.sensors.getTempCByIndex(b.count() - 1); }
+static void runGetTempC(Bench& b) { b.sensors.getTempC(b.last); }
+static void runGetTempMilliC(Bench& b) { b.sensors.getTempMilliC(b.last); }
+static void runReadAll(Bench& b) {
+    std::vector<DallasTemperature::Reading> readings(b.count());
+    b.sensors.readAll(readings.data(), readings.size());
+}
+static void runSweepByIndex(Bench& b) {
+    for (DeviceIndex i = 0; i < b.count(); i++) b.sensors.getTempCByIndex(i);
+}
+static void runIsConnected(Bench& b) { b.sensors.isConnected(b.last); }
+static void runReadPowerSupply(Bench& b) { b.sensors.readPowerSupply(); }
+static void runGetResolution(Bench& b) { b.sensors.getResolution(b.last); }
+static void runSetResolutionAll(Bench& b) { b.sensors.setResolution(10); }
+static void runSetResolution(Bench& b) { b.sensors.setResolution(b.last, 10); }
+static void runSetHighAlarmTemp(Bench& b) { b.sensors.setHighAlarmTemp(b.last, 60); }
+static void runHasAlarm(Bench& b) { b.sensors.hasAlarm(); }
+static void runProcessAlarms(Bench& b) { b.sensors.processAlarms(); }
+static void runSetUserData(Bench& b) { b.sensors.setUserData(b.last, 0x1234); }
+static void runGetUserData(Bench& b) { b.sensors.getUserData(b.last); }
+static void runSaveScratchPad(Bench& b) { b.sensors.saveScratchPad(); }
+static void runRecallScratchPad(Bench& b) { b.sensors.recallScratchPad(); }
+
+struct BenchCase {
+    const char* name;
+    void (*setup)(Bench&);
+    void (*run)(Bench&);
+};
+
+static const BenchCase cases[] = {
+    { "begin",                         none,                    runBegin },
+    { "begin(storage)",                enumerateSaved,          runBeginStorage },
+    { "rescan",                        enumerate,               runRescan },
+    { "verifyDeviceCount",             enumerate,               runVerifyDeviceCount },
+    { "scanForChanges",                enumerate,               runScanForChanges },
+    { "requestTemperatures",           enumerate,               runRequestTemperatures },
+    { "requestTemperatures(nowait)",   enumerateNoWait,         runRequestTemperatures },
+    { "requestTemperaturesByIndex",    enumerateNoWait,         runRequestByIndexLast },
+    { "getTempCByIndex(first)",        enumerateConverted,      runGetTempCByIndexFirst },
+    { "getTempCByIndex(last)",         enumerateConverted,      runGetTempCByIndexLast },
+    { "getTempC",                      enumerateConverted,      runGetTempC },
+    { "getTempMilliC",                 enumerateConverted,      runGetTempMilliC },
+    { "getTempC(fast)",                enumerateConvertedFast,  runGetTempC },
+    { "readAll",                       enumerateConverted,      runReadAll },
+    { "readAll(fast)",                 enumerateConvertedFast,  runReadAll },
+    { "sweep getTempCByIndex(table)",  enumerateConvertedTable, runSweepByIndex },
+    { "sweep readAll(table)",          enumerateConvertedTable, runReadAll },
+    { "isConnected",                   enumerate,               runIsConnected },
+    { "readPowerSupply",               enumerate,               runReadPowerSupply },
+    { "getResolution",                 enumerate,               runGetResolution },
+    { "setResolution(uint8_t)",        enumerate,               runSetResolutionAll },
+    { "setResolution(address)",        enumerate,               runSetResolution },
+    { "setHighAlarmTemp",              enumerate,               runSetHighAlarmTemp },
+    { "hasAlarm",                      enumerateOneAlarm,       runHasAlarm },
+    { "processAlarms",                 enumerateOneAlarm,       runProcessAlarms },
+    { "setUserData",                   enumerate,               runSetUserData },
+    { "getUserData",                   enumerate,               runGetUserData },
+    { "saveScratchPad",                enumerate,               runSaveScratchPad },
+    { "recallScratchPad",              enumerate,               runRecallScratchPad },
+};
+
+int main(int argc, char** argv) {
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--csv") == 0) json = false;
+        else {
+            fprintf(stderr, "usage: %s [--csv|--json]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (json) printf("[\n");
+    else printf("api,devices,resets,bytes_written,bytes_read,bits_written,bits_read,bus_us,elapsed_us\n");
+
+    bool first = true;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (size_t d = 0; d < sizeof(deviceCounts) / sizeof(deviceCounts[0]); d++) {
+            Bench b(deviceCounts[d]);
+            cases[c].setup(b);
+
+            b.oneWire.resetStats();
+            uint64_t start = simMicros;
+            cases[c].run(b);
+            uint64_t elapsed = simMicros - start;
+            const SimBusStats& s = b.oneWire.stats;
+
+            if (json) {
+                printf("%s  {\"api\": \"%s\", \"devices\": %u, \"resets\": %u, "
+                       "\"bytes_written\": %u, \"bytes_read\": %u, \"bits_written\": %u, "
+                       "\"bits_read\": %u, \"bus_us\": %llu, \"elapsed_us\": %llu}",
+                       first ? "" : ",\n", cases[c].name, deviceCounts[d], s.resets,
+                       s.bytesWritten, s.bytesRead, s.bitsWritten, s.bitsRead,
+                       (unsigned long long)s.busMicros, (unsigned long long)elapsed);
+            } else {
+                printf("%s,%u,%u,%u,%u,%u,%u,%llu,%llu\n", cases[c].name, deviceCounts[d],
+                       s.resets, s.bytesWritten, s.bytesRead, s.bitsWritten, s.bitsRead,
+                       (unsigned long long)s.busMicros, (unsigned long long)elapsed);
+            }
+            first = false;
+        }
+    }
+    if (json) printf("\n]\n");
+    return 0;
+}
@@ -0,0 +1,1768 @@
+//    FILE: test_DallasTemperature.cpp
+// PURPOSE: DallasTemperature against simulated devices, covering the
+//          search, scratchpad, alarm and conversion paths
+
+#include <ArduinoUnitTests.h>
+#include <Arduino.h>
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include <stdio.h>
+#include <vector>
+
+#define ONE_WIRE_BUS 2
+
+unittest(test_begin) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 b20(1);
+    SimDS18S20 s20(2);
+    SimSwitch ds2413(3);
+    b20.setParasite(true);
+    oneWire.attach(&b20);
+    oneWire.attach(&s20);
+    oneWire.attach(&ds2413);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+
+    assertEqual(3, sensors.getDeviceCount());
+    assertEqual(2, sensors.getDS18Count());
+    assertTrue(sensors.isParasitePowerMode());
+    assertEqual(12, sensors.getResolution());
+
+    int parasites = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        const DallasTemperature::DeviceInfo* info = sensors.getDeviceInfo(i);
+        assertTrue(info != nullptr);
+        if (info->parasite) parasites++;
+        if (info->family() == 0x3A) assertEqual(0, info->resolution);
+    }
+    assertEqual(1, parasites);
+}
+
+// The integer API matches the float one without using floating point
+unittest(test_integer_api) {
+    static_assert(DallasTemperature::rawToMilliCelsius(25 * 128) == 25000, "constexpr");
+    static_assert(DallasTemperature::milliCelsiusToAlarm(-500) == -1, "constexpr");
+
+    // -55 C itself reads as DEVICE_DISCONNECTED_RAW
+    for (int32_t raw = -55 * 128 + 8; raw <= 125 * 128; raw += 8) {
+        // exact in double: the divisors are powers of two
+        double c = raw / 128.0;
+        double milliF = (raw * 225.0 + 512000) / 16;
+        assertEqual(lround(c * 1000), DallasTemperature::rawToMilliCelsius(raw));
+        assertEqual(lround(milliF), DallasTemperature::rawToMilliFahrenheit(raw));
+        assertEqual(lround(c * 100), DallasTemperature::rawToCentiCelsius(raw));
+        assertEqual(lround(milliF / 10), DallasTemperature::rawToCentiFahrenheit(raw));
+        assertEqualFloat(DallasTemperature::rawToFahrenheit(raw),
+                         DallasTemperature::rawToMilliFahrenheit(raw) / 1000.0, 0.001);
+        int32_t milliC = DallasTemperature::rawToMilliCelsius(raw);
+        assertEqual(raw, DallasTemperature::milliCelsiusToRaw(milliC));
+        // converting an already rounded value may be one off
+        assertLessOrEqual(labs(DallasTemperature::rawToMilliFahrenheit(raw)
+                               - DallasTemperature::milliCelsiusToMilliFahrenheit(milliC)), 1);
+        assertLessOrEqual(labs(milliC - DallasTemperature::milliFahrenheitToMilliCelsius(
+                                            DallasTemperature::rawToMilliFahrenheit(raw))), 1);
+        assertEqual((int8_t)floor(c), DallasTemperature::milliCelsiusToAlarm(milliC));
+    }
+    assertEqual(125, DallasTemperature::milliCelsiusToAlarm(400000));
+    assertEqual(-55, DallasTemperature::milliCelsiusToAlarm(-60000));
+    assertEqual(-20000, DallasTemperature::alarmToMilliCelsius(-20));
+    // MAX31850 thermocouples reach 1800 C
+    assertEqual(180000, DallasTemperature::rawToCentiCelsius(1800 * 128));
+    assertEqual(327200, DallasTemperature::rawToCentiFahrenheit(1800 * 128));
+    assertEqual(3272000, DallasTemperature::rawToMilliFahrenheit(1800 * 128));
+
+    assertEqual(DEVICE_DISCONNECTED_MILLIC, DallasTemperature::rawToMilliCelsius(DEVICE_DISCONNECTED_RAW));
+    assertEqual(DEVICE_DISCONNECTED_MILLIF, DallasTemperature::rawToMilliFahrenheit(DEVICE_FAULT_OPEN_RAW));
+    assertEqual(DEVICE_DISCONNECTED_CENTIC, DallasTemperature::rawToCentiCelsius(DEVICE_DISCONNECTED_RAW));
+    assertEqual(DEVICE_DISCONNECTED_CENTIF, DallasTemperature::rawToCentiFahrenheit(DEVICE_DISCONNECTED_RAW));
+
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    a.setTemperature(-10.5);
+    oneWire.attach(&a);
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+    assertEqual(-10500, sensors.getTempMilliC(a.address()));
+    assertEqual(13100, sensors.getTempMilliF(a.address()));
+    assertEqual(-10500, sensors.getTempMilliCByIndex(0));
+    assertEqual(13100, sensors.getTempMilliFByIndex(0));
+    assertEqual(DEVICE_DISCONNECTED_MILLIC, sensors.getTempMilliCByIndex(1));
+    assertEqual(DEVICE_DISCONNECTED_MILLIF, sensors.getTempMilliFByIndex(1));
+}
+
+static uint8_t devicesAdded;
+static uint8_t devicesRemoved;
+static DeviceAddress lastChanged;
+
+static void onDeviceChange(const uint8_t* deviceAddress, bool added) {
+    if (added) devicesAdded++;
+    else devicesRemoved++;
+    memcpy(lastChanged, deviceAddress, 8);
+}
+
+// Hot-plug: one search pass, only the new device is probed
+unittest(test_scan_for_changes) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint64_t i = 0; i < 10; i++) {
+        devices.push_back(new SimDS18B20(0x5000 + i * 6151));
+        oneWire.attach(devices.back());
+    }
+    SimDS18B20 hotplug(0x4242);
+    hotplug.setParasite(true);
+    SimSwitch ds2413(0x77);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceChangeHandler(onDeviceChange);
+    sensors.begin();
+    devicesAdded = devicesRemoved = 0;
+
+    oneWire.resetStats();
+    assertEqual(0, sensors.scanForChanges());
+    assertEqual(0, devicesAdded + devicesRemoved);
+    // one search per device and nothing else
+    assertEqual(10u, oneWire.stats.resets);
+    assertFalse(sensors.verifyDeviceCount());
+
+    oneWire.detach(devices[4]);
+    oneWire.attach(&hotplug);
+    oneWire.attach(&ds2413);
+    uint32_t reads = devices[0]->scratchpadReads;
+    assertEqual(3, sensors.scanForChanges());
+    assertEqual(2, devicesAdded);
+    assertEqual(1, devicesRemoved);
+    assertEqual(reads, devices[0]->scratchpadReads);
+    assertEqual(1u, hotplug.scratchpadReads);
+    assertEqual(11, sensors.getDeviceCount());
+    assertEqual(10, sensors.getDS18Count());
+    assertTrue(sensors.isParasitePowerMode());
+
+    // the table stays in search order, as begin() would have built it
+    DallasTemperature fresh(&oneWire);
+    fresh.begin();
+    for (uint8_t i = 0; i < 11; i++) {
+        assertTrue(memcmp(fresh.getDeviceInfo(i)->address, sensors.getDeviceInfo(i)->address, 8) == 0);
+        assertEqual(fresh.getDeviceInfo(i)->resolution, sensors.getDeviceInfo(i)->resolution);
+    }
+
+    oneWire.detach(&hotplug);
+    assertEqual(1, sensors.scanForChanges());
+    assertTrue(memcmp(lastChanged, hotplug.address(), 8) == 0);
+    assertFalse(sensors.isParasitePowerMode());
+
+    oneWire.attach(devices[4]);
+    assertTrue(sensors.verifyDeviceCount());
+    assertEqual(11, sensors.getDeviceCount());
+
+    oneWire.detach(&ds2413);
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+// Past a full table the indices still follow the search order
+unittest(test_scan_for_changes_small_table) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    // found in the order a, b, c
+    SimDS18B20 a(0x10), b(0x50), c(0x30);
+    oneWire.attach(&a);
+    oneWire.attach(&c);
+
+    DallasTemperature::DeviceInfo table[2];
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceTable(table, 2);
+    sensors.begin();
+
+    oneWire.attach(&b);
+    assertEqual(1, sensors.scanForChanges());
+    assertEqual(3, sensors.getDeviceCount());
+
+    DallasTemperature fresh(&oneWire);
+    fresh.begin();
+    DeviceAddress expected, actual;
+    for (uint8_t i = 0; i < 3; i++) {
+        assertTrue(fresh.getAddress(expected, i));
+        assertTrue(sensors.getAddress(actual, i));
+        assertTrue(memcmp(expected, actual, 8) == 0);
+    }
+}
+
+// A DeviceTable keeps each device's latest reading next to its address
+unittest(test_device_pool) {
+    static_assert(DallasTemperature::DeviceTable<4>::bytes ==
+                  4 * (sizeof(DallasTemperature::DeviceInfo) + sizeof(DallasTemperature::Reading)),
+                  "pool size is known at compile time");
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(0x10), b(0x50), c(0x30);
+    a.setTemperature(20.5);
+    b.setTemperature(-3.25);
+    c.setTemperature(40);
+    oneWire.attach(&a);
+    oneWire.attach(&c);
+
+    static DallasTemperature::DeviceTable<4> pool;
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceTable(pool);
+    sensors.begin();
+    assertEqual(2, sensors.getDeviceCount());
+    assertEqual(DallasTemperature::READING_DISCONNECTED, sensors.getLatestReading(0)->status);
+    assertEqual(nullptr, sensors.getLatestReading(2));
+
+    sensors.requestTemperatures();
+    assertEqual(20.5 * 128, sensors.getTemp(pool.devices[0].address));
+    DallasTemperature::Reading reading;
+    assertTrue(sensors.getReadingByIndex(1, &reading));
+
+    const DallasTemperature::Reading* latest = sensors.getLatestReading(0);
+    assertEqual(DallasTemperature::READING_OK, latest->status);
+    assertEqual(20.5 * 128, latest->raw);
+    assertEqual(40 * 128, sensors.getLatestReading(1)->raw);
+
+    // b is found between a and c, and the readings move with the addresses
+    oneWire.attach(&b);
+    assertEqual(1, sensors.scanForChanges());
+    assertEqual(DallasTemperature::READING_DISCONNECTED, sensors.getLatestReading(1)->status);
+    assertEqual(40 * 128, sensors.getLatestReading(2)->raw);
+
+    oneWire.detach(&a);
+    assertEqual(1, sensors.scanForChanges());
+    assertEqual(40 * 128, sensors.getLatestReading(1)->raw);
+    assertEqual(nullptr, sensors.getLatestReading(2));
+
+    // a plain table keeps no readings
+    DallasTemperature::DeviceInfo table[4];
+    sensors.setDeviceTable(table, 4);
+    sensors.begin();
+    assertEqual(nullptr, sensors.getLatestReading(0));
+}
+
+// Family search walks only the thermometers
+unittest(test_family_search) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDevice*> devices;
+    for (uint64_t i = 0; i < 24; i++) {
+        SimDevice* device;
+        switch (i % 4) {
+            case 0: device = new SimDS18B20(0x6000 + i * 977); break;
+            case 1: device = new SimSwitch(0x6000 + i * 977, 0x3A); break;    // DS2413
+            case 2: device = new SimSwitch(0x6000 + i * 977, 0x2D); break;    // DS2431
+            default: device = i == 3 ? (SimDevice*)new SimDS18S20(0x6000 + i * 977)
+                                     : (SimDevice*)new SimSwitch(0x6000 + i * 977, 0x29);
+        }
+        devices.push_back(device);
+        oneWire.attach(device);
+    }
+    SimDS1822 ds1822(0x9999);
+    SimMAX31850 max31850(0x8888);
+    oneWire.attach(&ds1822);
+    oneWire.attach(&max31850);
+
+    DallasTemperature all(&oneWire);
+    oneWire.resetStats();
+    all.begin();
+    uint32_t fullCost = oneWire.stats.bitsRead;
+
+    DallasTemperature sensors(&oneWire);
+    sensors.setFamilySearch(true);
+    assertTrue(sensors.getFamilySearch());
+    oneWire.resetStats();
+    sensors.begin();
+    assertLess(oneWire.stats.bitsRead, fullCost);
+
+    assertEqual(26, all.getDeviceCount());
+    assertEqual(9, sensors.getDeviceCount());
+    assertEqual(9, sensors.getDS18Count());
+
+    // same thermometers, in the same order
+    uint8_t j = 0;
+    for (uint8_t i = 0; i < all.getDeviceCount(); i++) {
+        const DallasTemperature::DeviceInfo* info = all.getDeviceInfo(i);
+        if (!all.validFamily(info->address)) continue;
+        assertTrue(memcmp(info->address, sensors.getDeviceInfo(j++)->address, 8) == 0);
+    }
+    assertEqual(9, j);
+
+    // the walk past the table is pruned as well
+    DallasTemperature::DeviceInfo table[2];
+    DallasTemperature small(&oneWire);
+    small.setFamilySearch(true);
+    small.setDeviceTable(table, 2);
+    small.begin();
+    DeviceAddress addr;
+    assertTrue(small.getAddress(addr, 8));
+    assertTrue(memcmp(addr, sensors.getDeviceInfo(8)->address, 8) == 0);
+    assertFalse(small.getAddress(addr, 9));
+
+    oneWire.detach(&ds1822);
+    assertEqual(1, sensors.scanForChanges());
+    assertEqual(8, sensors.getDeviceCount());
+
+    // a bus without thermometers is given up on within the family code
+    OneWire other(ONE_WIRE_BUS);
+    SimSwitch lonely(1);
+    other.attach(&lonely);
+    DallasTemperature none(&other);
+    none.setFamilySearch(true);
+    none.begin();
+    assertEqual(0, none.getDeviceCount());
+
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+// Device table storage backed by a temporary file
+class FileStorage : public DallasTemperature::Storage {
+public:
+    FileStorage() : file(tmpfile()) {}
+    ~FileStorage() { fclose(file); }
+    bool read(uint16_t offset, uint8_t* data, uint16_t length) {
+        return fseek(file, offset, SEEK_SET) == 0 && fread(data, 1, length, file) == length;
+    }
+    bool write(uint16_t offset, const uint8_t* data, uint16_t length) {
+        return fseek(file, offset, SEEK_SET) == 0 && fwrite(data, 1, length, file) == length;
+    }
+    FILE* file;
+};
+
+// Warm start: a saved table only needs one short read per device
+unittest(test_device_table_storage) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDevice*> devices;
+    for (uint64_t i = 0; i < 12; i++) {
+        devices.push_back(i == 5 ? (SimDevice*)new SimDS18S20(0x7000 + i * 4099)
+                                 : (SimDevice*)new SimDS18B20(0x7000 + i * 4099));
+        oneWire.attach(devices.back());
+    }
+    devices[2]->setParasite(true);
+    FileStorage storage;
+
+    DallasTemperature cold(&oneWire);
+    assertFalse(cold.begin(&storage));
+    assertEqual(12, cold.getDeviceCount());
+    cold.setResolution(devices[0]->address(), 10);
+    assertTrue(cold.saveDeviceTable(&storage));
+    fseek(storage.file, 0, SEEK_END);
+    assertEqual(DallasTemperature::deviceTableStorageSize(12), (uint16_t)ftell(storage.file));
+
+    oneWire.resetStats();
+    uint64_t start = simMicros;
+    DallasTemperature coldAgain(&oneWire);
+    coldAgain.begin();
+    uint64_t coldMicros = simMicros - start;
+
+    oneWire.resetStats();
+    start = simMicros;
+    DallasTemperature warm(&oneWire);
+    assertTrue(warm.begin(&storage));
+    uint64_t warmMicros = simMicros - start;
+    // one read per device and the power supply query
+    assertEqual(14u, oneWire.stats.resets);
+    assertLess(warmMicros * 3, coldMicros);
+
+    assertEqual(12, warm.getDeviceCount());
+    assertEqual(12, warm.getDS18Count());
+    assertEqual(12, warm.getResolution());
+    assertTrue(warm.isParasitePowerMode());
+    for (uint8_t i = 0; i < 12; i++) {
+        const DallasTemperature::DeviceInfo* expected = coldAgain.getDeviceInfo(i);
+        const DallasTemperature::DeviceInfo* actual = warm.getDeviceInfo(i);
+        assertTrue(memcmp(expected->address, actual->address, 8) == 0);
+        assertEqual(expected->resolution, actual->resolution);
+        assertEqual(expected->parasite, actual->parasite);
+    }
+    warm.requestTemperatures();
+    assertEqual(20.0, warm.getTempCByIndex(11));
+
+    // a device changed behind the table's back forces a full search
+    uint8_t scratchPad[9];
+    memcpy(scratchPad, devices[3]->scratchpad(), 9);
+    scratchPad[2] = 99;
+    coldAgain.setAutoSaveScratchPad(false);
+    coldAgain.writeScratchPad(devices[3]->address(), scratchPad);
+    DallasTemperature changed(&oneWire);
+    assertFalse(changed.begin(&storage));
+    assertEqual(12, changed.getDeviceCount());
+
+    // so does a missing one
+    oneWire.detach(devices[7]);
+    DallasTemperature missing(&oneWire);
+    assertFalse(missing.begin(&storage));
+    assertEqual(11, missing.getDeviceCount());
+
+    // and a corrupted file
+    assertTrue(missing.saveDeviceTable(&storage));
+    fseek(storage.file, 20, SEEK_SET);
+    fputc(0x55, storage.file);
+    DallasTemperature corrupt(&oneWire);
+    assertFalse(corrupt.begin(&storage));
+    assertEqual(11, corrupt.getDeviceCount());
+
+    oneWire.attach(devices[7]);
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+
+    // other families are checked by ROM, without a function command
+    OneWire mixed(ONE_WIRE_BUS);
+    SimDS18B20 a(0x7100);
+    SimSwitch sw(0x7101, 0x3A);
+    mixed.attach(&a);
+    mixed.attach(&sw);
+    FileStorage mixedStorage;
+    DallasTemperature first(&mixed);
+    first.begin();
+    assertEqual(2, first.getDeviceCount());
+    assertTrue(first.saveDeviceTable(&mixedStorage));
+    sw.functions = 0;
+    DallasTemperature again(&mixed);
+    assertTrue(again.begin(&mixedStorage));
+    assertEqual(0u, sw.functions);
+    assertEqual(2, again.getDeviceCount());
+
+    mixed.detach(&sw);
+    DallasTemperature gone(&mixed);
+    assertFalse(gone.begin(&mixedStorage));
+    assertEqual(1, gone.getDeviceCount());
+}
+
+// Many devices: index lookups come from the address table
+unittest(test_index_lookup) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint64_t i = 0; i < 32; i++) {
+        devices.push_back(new SimDS18B20(0x1000 + i * 7919));
+        devices.back()->setTemperature(i);
+        oneWire.attach(devices.back());
+    }
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    assertEqual(32, sensors.getDeviceCount());
+    sensors.requestTemperatures();
+
+    oneWire.resetStats();
+    for (uint8_t i = 0; i < 32; i++) {
+        float t = sensors.getTempCByIndex(i);
+        assertMoreOrEqual(t, 0);
+        assertLess(t, 32);
+    }
+    // one read per device, no searches
+    assertEqual(32u * 2, oneWire.stats.resets);
+
+    DeviceAddress addr;
+    assertFalse(sensors.getAddress(addr, 32));
+
+    oneWire.detach(devices[0]);
+    assertEqual(31, sensors.rescan());
+
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+// Past 255 devices on one bus, with 16 bit indices
+unittest(test_more_than_255_devices) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint64_t i = 0; i < 300; i++) {
+        devices.push_back(new SimDS18B20(0x20000 + i * 7919));
+        devices.back()->setTemperature((i % 64) / 4.0);
+        oneWire.attach(devices.back());
+    }
+    FileStorage storage;
+
+    static DallasTemperature::DeviceTable<300> pool;
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceTable(pool);
+    sensors.begin();
+    assertEqual(300, sensors.getDeviceCount());
+    assertEqual(300, sensors.getDS18Count());
+    sensors.requestTemperatures();
+
+    oneWire.resetStats();
+    for (DeviceIndex i = 0; i < 300; i++) {
+        uint64_t serial = 0;
+        for (uint8_t b = 6; b >= 1; b--) serial = (serial << 8) | pool.devices[i].address[b];
+        uint64_t n = (serial - 0x20000) / 7919;
+        assertEqual((int32_t)(n % 64) * 250, sensors.getTempMilliCByIndex(i));
+        assertEqual(DallasTemperature::READING_OK, sensors.getLatestReading(i)->status);
+    }
+    // one read per device, no searches
+    assertEqual(300u * 2, oneWire.stats.resets);
+
+    std::vector<DallasTemperature::Reading> readings(300);
+    assertEqual(300, sensors.readAll(readings.data(), readings.size()));
+    for (DeviceIndex i = 0; i < 300; i++) {
+        assertEqual(sensors.getLatestReading(i)->raw, readings[i].raw);
+    }
+
+    // counts above 255 survive a warm start
+    assertTrue(sensors.saveDeviceTable(&storage));
+    DallasTemperature warm(&oneWire);
+    warm.setDeviceTable(pool);
+    assertTrue(warm.begin(&storage));
+    assertEqual(300, warm.getDeviceCount());
+
+    oneWire.detach(devices[280]);
+    assertEqual(1, warm.scanForChanges());
+    assertEqual(299, warm.getDeviceCount());
+
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+unittest(test_small_table_falls_back_to_search) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2), c(3);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+    oneWire.attach(&c);
+
+    DallasTemperature::DeviceInfo table[1];
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceTable(table, 1);
+    sensors.begin();
+    assertEqual(3, sensors.getDeviceCount());
+
+    DeviceAddress first, last;
+    assertTrue(sensors.getAddress(first, 0));
+    assertTrue(sensors.getAddress(last, 2));
+    assertTrue(memcmp(first, table[0].address, 8) == 0);
+    assertTrue(sensors.getDeviceInfo(2) == nullptr);
+}
+
+unittest(test_families) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 b20(1);
+    SimDS18S20 s20(2);
+    SimDS1822 ds1822(3);
+    SimDS1825 ds1825(4);
+    SimDS28EA00 ds28ea00(5);
+    SimMAX31850 max31850(6);
+    b20.setTemperature(21.5);
+    s20.setTemperature(-10.25);
+    ds1822.setTemperature(0.5);
+    ds1825.setTemperature(100);
+    ds28ea00.setTemperature(-40);
+    max31850.setTemperature(812.25);
+    oneWire.attach(&b20);
+    oneWire.attach(&s20);
+    oneWire.attach(&ds1822);
+    oneWire.attach(&ds1825);
+    oneWire.attach(&ds28ea00);
+    oneWire.attach(&max31850);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    assertEqual(6, sensors.getDS18Count());
+    sensors.requestTemperatures();
+
+    assertEqualFloat(21.5, sensors.getTempC(b20.address()), 0.001);
+    assertEqualFloat(-10.25, sensors.getTempC(s20.address()), 0.07);
+    assertEqualFloat(0.5, sensors.getTempC(ds1822.address()), 0.001);
+    assertEqualFloat(100, sensors.getTempC(ds1825.address()), 0.001);
+    assertEqualFloat(-40, sensors.getTempF(ds28ea00.address()), 0.001);
+    assertEqualFloat(812.25, sensors.getTempC(max31850.address()), 0.001);
+#if REQUIRESHEALTH
+    // thermocouple readings need more than 16 bits of 1/128 C
+    for (uint8_t i = 0; i < 6; i++) {
+        const DallasTemperature::DeviceInfo* info = sensors.getDeviceInfo(i);
+        if (memcmp(info->address, max31850.address(), 8) == 0) assertEqual(812.25 * 128, info->health.lastRaw);
+    }
+#endif
+
+    max31850.setFault(SimMAX31850::SHORT_VDD);
+    sensors.requestTemperatures();
+    assertEqual(DEVICE_FAULT_SHORTVDD_RAW, sensors.getTemp(max31850.address()));
+}
+
+unittest(test_resolution) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    assertTrue(sensors.setResolution(a.address(), 9));
+    assertEqual(9, sensors.getResolution(a.address()));
+    // saved to EEPROM by default
+    assertEqual(0x1F, a.eeprom()[2]);
+    assertEqual(12, sensors.getResolution());
+
+    sensors.setResolution(10);
+    assertEqual(10, a.resolution());
+    assertEqual(10, b.resolution());
+    assertEqual(10, sensors.getResolution());
+
+    // the conversion wait follows the resolution
+    unsigned long start = millis();
+    sensors.setCheckForConversion(false);
+    sensors.requestTemperatures();
+    assertMoreOrEqual(millis() - start, 188u);
+    assertLess(millis() - start, 195u);
+}
+
+unittest(test_disconnected) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+
+    b.setConnected(false);
+    assertTrue(sensors.isConnected(a.address()));
+    assertFalse(sensors.isConnected(b.address()));
+    assertEqual(DEVICE_DISCONNECTED_C, sensors.getTempC(b.address()));
+    assertEqual(DEVICE_DISCONNECTED_C, sensors.getTempCByIndex(5));
+
+    // a corrupted read is retried
+    a.corruptReads(1);
+    assertEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address()));
+    a.corruptReads(1);
+    assertNotEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address(), 1));
+}
+
+unittest(test_parasite_conversion) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    a.setParasite(true);
+    a.setTemperature(42);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+    assertEqualFloat(42, sensors.getTempC(a.address()), 0.001);
+}
+
+unittest(test_alarms) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2);
+    a.setTemperature(30);
+    b.setTemperature(20);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.setHighAlarmTemp(a.address(), 25);
+    sensors.setLowAlarmTemp(a.address(), -5);
+    sensors.setHighAlarmTemp(b.address(), 25);
+    sensors.setLowAlarmTemp(b.address(), -5);
+    assertEqual(25, sensors.getHighAlarmTemp(a.address()));
+    assertEqual(-5, sensors.getLowAlarmTemp(a.address()));
+
+    sensors.requestTemperatures();
+    assertTrue(sensors.hasAlarm());
+    assertTrue(sensors.hasAlarm(a.address()));
+    assertFalse(sensors.hasAlarm(b.address()));
+
+    DeviceAddress found;
+    sensors.resetAlarmSearch();
+    assertTrue(sensors.alarmSearch(found));
+    assertTrue(memcmp(found, a.address(), 8) == 0);
+    assertFalse(sensors.alarmSearch(found));
+}
+
+unittest(test_user_data_and_eeprom) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.setUserDataByIndex(0, 0x1234);
+    assertEqual(0x1234, sensors.getUserDataByIndex(0));
+    assertEqual(0x12, a.eeprom()[0]);
+
+    sensors.setAutoSaveScratchPad(false);
+    sensors.setUserData(a.address(), 0x0101);
+    assertEqual(0x12, a.eeprom()[0]);
+    assertTrue(sensors.recallScratchPadByIndex(0));
+    assertEqual(0x1234, sensors.getUserData(a.address()));
+
+    sensors.setUserData(a.address(), 0x0101);
+    assertTrue(sensors.saveScratchPadByIndex(0));
+    assertEqual(0x01, a.eeprom()[0]);
+}
+
+#if REQUIRESEEPROMQUEUE
+static uint8_t eepromDone;
+static uint8_t eepromFailed;
+
+static void onEeprom(const uint8_t*, bool ok) {
+    if (ok) eepromDone++;
+    else eepromFailed++;
+}
+
+// Queued EEPROM copies and recalls finish on later tick() calls
+unittest(test_eeprom_queue) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.setWaitForEeprom(false);
+    assertFalse(sensors.getWaitForEeprom());
+    sensors.setEepromHandler(onEeprom);
+    eepromDone = eepromFailed = 0;
+
+    sensors.setUserData(a.address(), 0x1234);
+    sensors.setUserData(b.address(), 0x5678);
+    assertEqual(0u, sensors.getBusStats().eepromWaitMillis);
+    assertEqual(2, sensors.getPendingEeprom());
+    // a save already waiting is not queued twice
+    assertTrue(sensors.saveScratchPad(b.address()));
+    assertEqual(2, sensors.getPendingEeprom());
+
+    uint64_t start = simMicros;
+    while (sensors.getPendingEeprom() > 0) {
+        sensors.tick();
+        delay(1);
+    }
+    assertEqual(2, eepromDone);
+    assertEqual(0, eepromFailed);
+    assertEqual(0x12, a.eeprom()[0]);
+    assertEqual(0x56, b.eeprom()[0]);
+    // the devices report the end of the copy before the 20 ms worst case
+    assertLess(simMicros - start, 2000u * MAX_EEPROM_WRITE_TIME);
+    assertEqual(0u, sensors.getBusStats().eepromWaitMillis);
+
+    sensors.setAutoSaveScratchPad(false);
+    sensors.setUserData(a.address(), 0x0101);
+    assertTrue(sensors.recallScratchPad(a.address()));
+    while (sensors.getPendingEeprom() > 0) sensors.tick();
+    assertEqual(3, eepromDone);
+    assertEqual(0x1234, sensors.getUserData(a.address()));
+}
+
+// A fleet fits the queue, and a full queue fails at once instead of waiting
+unittest(test_eeprom_queue_full) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint16_t i = 0; i <= EEPROM_QUEUE_SIZE; i++) {
+        devices.push_back(new SimDS18B20(0x2000 + i));
+        oneWire.attach(devices.back());
+    }
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.setWaitForEeprom(false);
+    sensors.setEepromHandler(onEeprom);
+    eepromDone = eepromFailed = 0;
+
+    // a resolution change per table device queues one copy each
+    for (DeviceIndex i = 0; i < DEVICE_CACHE_SIZE; i++) {
+        assertTrue(sensors.setResolution(devices[i]->address(), 9));
+    }
+    assertEqual(DEVICE_CACHE_SIZE, sensors.getPendingEeprom());
+    for (uint16_t i = DEVICE_CACHE_SIZE; i < EEPROM_QUEUE_SIZE; i++) {
+        assertTrue(sensors.saveScratchPad(devices[i]->address()));
+    }
+    uint64_t start = simMicros;
+    assertFalse(sensors.saveScratchPad(devices[EEPROM_QUEUE_SIZE]->address()));
+    assertEqual(0u, simMicros - start);
+    assertEqual(1, eepromFailed);
+    assertEqual(EEPROM_QUEUE_SIZE, sensors.getPendingEeprom());
+
+    while (sensors.getPendingEeprom() > 0) {
+        sensors.tick();
+        delay(1);
+    }
+    assertEqual(EEPROM_QUEUE_SIZE, eepromDone);
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+// On parasite power other bus calls wait for a running copy
+unittest(test_eeprom_queue_parasite) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    a.setParasite(true);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    assertTrue(sensors.isParasitePowerMode());
+    sensors.setWaitForEeprom(false);
+    sensors.setEepromHandler(onEeprom);
+    eepromDone = eepromFailed = 0;
+
+    sensors.setUserData(a.address(), 0x4321);
+    sensors.tick();
+    assertEqual(1, sensors.getPendingEeprom());
+    assertEqual(0u, a.eepromWrites);
+
+    // reading the device right away would starve the copy
+    uint64_t start = simMicros;
+    assertEqual(0x4321, sensors.getUserData(a.address()));
+    assertMoreOrEqual(simMicros - start, 1000u * (MAX_EEPROM_WRITE_TIME - 1));
+    assertEqual(1u, a.eepromWrites);
+    assertEqual(0x43, a.eeprom()[0]);
+    assertEqual(0, sensors.getPendingEeprom());
+    assertEqual(1, eepromDone);
+}
+#endif
+
+unittest(test_read_all) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2);
+    SimSwitch ds2413(3);
+    SimMAX31850 max31850(4);
+    max31850.setFault(SimMAX31850::OPEN);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+    oneWire.attach(&ds2413);
+    oneWire.attach(&max31850);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+    b.corruptReads(1);
+
+    DallasTemperature::Reading readings[8];
+    oneWire.resetStats();
+    assertEqual(4, sensors.readAll(readings, 8));
+    // one reset per thermometer, none for the switch
+    assertEqual(3u, oneWire.stats.resets);
+
+    int ok = 0, crc = 0, unsupported = 0, fault = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        switch (readings[i].status) {
+            case DallasTemperature::READING_OK: ok++; break;
+            case DallasTemperature::READING_CRC_ERROR: crc++; break;
+            case DallasTemperature::READING_UNSUPPORTED: unsupported++; break;
+            case DallasTemperature::READING_FAULT: fault++; break;
+        }
+    }
+    assertEqual(1, ok);
+    assertEqual(1, crc);
+    assertEqual(1, unsupported);
+    assertEqual(1, fault);
+}
+
+static uint8_t handlerCalls;
+static int32_t lastRaw;
+
+static void onTemperature(DeviceIndex, const uint8_t*, int32_t raw) {
+    handlerCalls++;
+    lastRaw = raw;
+}
+
+unittest(test_non_blocking) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    a.setTemperature(33);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.setTemperatureHandler(onTemperature);
+    handlerCalls = 0;
+
+    assertTrue(sensors.startConversion());
+    assertFalse(sensors.startConversion());
+    unsigned long start = millis();
+    while (sensors.tick() != DallasTemperature::CONVERSION_READY) {
+        // no tick may hold the bus for long
+        uint64_t before = simMicros;
+        delay(1);
+        assertLess(simMicros - before, 15000u);
+    }
+    assertMoreOrEqual(millis() - start, 600u);
+    assertEqual(1, handlerCalls);
+    assertEqual(33 * 128, lastRaw);
+}
+
+// The strong pullup is only driven for parasite conversions, and the bus
+// is left alone while it is
+unittest(test_non_blocking_pullup) {
+    const uint8_t PULLUP_PIN = 5;
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire, PULLUP_PIN);
+    sensors.begin();
+    assertTrue(sensors.startConversion());
+    uint32_t polls = 0;
+    while (sensors.tick() != DallasTemperature::CONVERSION_READY) {
+        assertEqual(HIGH, digitalRead(PULLUP_PIN));
+        polls++;
+        delay(1);
+    }
+    assertMore(polls, 0u);
+
+    a.setParasite(true);
+    sensors.begin();
+    assertTrue(sensors.startConversion());
+    oneWire.resetStats();
+    uint32_t pulledUp = 0;
+    while (sensors.tick() == DallasTemperature::CONVERSION_CONVERTING) {
+        assertEqual(LOW, digitalRead(PULLUP_PIN));
+        pulledUp++;
+        delay(1);
+    }
+    assertMore(pulledUp, 500u);
+    assertEqual(0u, oneWire.stats.bitsRead);
+    assertEqual(0u, oneWire.stats.resets);
+    while (sensors.tick() != DallasTemperature::CONVERSION_READY) {
+        assertEqual(HIGH, digitalRead(PULLUP_PIN));
+    }
+}
+
+// A missing device is given up on after the configuration byte, without retries
+unittest(test_absent_device) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18B20 b(2);
+    SimDS18S20 s20(3);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+    oneWire.attach(&s20);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+
+    a.setConnected(false);
+    s20.setConnected(false);
+    oneWire.resetStats();
+    assertEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address(), 5));
+    assertEqual(1u, oneWire.stats.resets);
+    assertEqual(5u, oneWire.stats.bytesRead);
+
+    DallasTemperature::Reading reading;
+    assertFalse(sensors.getReading(a.address(), &reading));
+    assertEqual(DallasTemperature::READING_DISCONNECTED, reading.status);
+
+    // no configuration register: the whole all-ones scratchpad is read
+    oneWire.resetStats();
+    assertEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(s20.address(), 5));
+    assertEqual(1u, oneWire.stats.resets);
+    assertEqual(9u, oneWire.stats.bytesRead);
+
+    // a corrupted read from a present device is still retried
+    b.corruptReads(1);
+    assertNotEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(b.address(), 1));
+}
+
+#if REQUIRESHEALTH
+// A failing sensor is probed with exponential backoff
+unittest(test_quarantine) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18B20 b(2);
+    a.setTemperature(30);
+    b.setTemperature(31);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    static DallasTemperature::DeviceTable<2> pool;
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceTable(pool);
+    sensors.begin();
+    sensors.requestTemperatures();
+    DeviceIndex ia = (memcmp(sensors.getDeviceInfo(0)->address, a.address(), 8) == 0) ? 0 : 1;
+    const DallasTemperature::DeviceInfo* info = sensors.getDeviceInfo(ia);
+
+    assertEqual(30.0, sensors.getTempC(a.address()));
+    assertEqual(30 * 128, info->health.lastRaw);
+    unsigned long good = info->health.lastGood;
+
+    // off by default: a failing device is read every time
+    a.setConnected(false);
+    DallasTemperature::Reading reading;
+    int probes = 0;
+    for (int sweep = 0; sweep < 10; sweep++) {
+        oneWire.resetStats();
+        assertFalse(sensors.getReading(a.address(), &reading));
+        if (oneWire.stats.resets > 0) probes++;
+    }
+    assertEqual(10, probes);
+    assertFalse(sensors.isQuarantined(a.address()));
+    assertEqual(10, info->health.failures);
+    assertEqual(good, info->health.lastGood);
+
+    sensors.resetHealth();
+    sensors.setQuarantineThreshold(3);
+    probes = 0;
+    for (int sweep = 0; sweep < 40; sweep++) {
+        oneWire.resetStats();
+        sensors.getReading(a.address(), &reading);
+        if (oneWire.stats.resets > 0) probes++;
+        assertEqual(31.0, sensors.getTempC(b.address()));
+    }
+    // reads 1-3, then probes at 5, 9, 17 and 33
+    assertEqual(7, probes);
+    assertTrue(sensors.isQuarantined(a.address()));
+    assertFalse(sensors.isQuarantined(b.address()));
+    assertFalse(sensors.getReading(a.address(), &reading));
+    assertEqual(DallasTemperature::READING_QUARANTINED, reading.status);
+
+    // the legacy getters still read a quarantined device
+    oneWire.resetStats();
+    assertEqual(DEVICE_DISCONNECTED_C, sensors.getTempC(a.address()));
+    assertMore(oneWire.stats.resets, 0u);
+
+    // back on the bus: the next probe clears the quarantine
+    a.setConnected(true);
+    sensors.resetHealth();
+    assertEqual(30.0, sensors.getTempC(a.address()));
+    assertFalse(sensors.isQuarantined(a.address()));
+    assertEqual(0, info->health.failures);
+
+    // CRC errors are counted, a retry still recovers the reading
+    a.corruptReads(1);
+    assertEqual(30.0, sensors.getTempC(a.address(), 1));
+    assertEqual(1, info->health.crcErrors);
+    assertEqual(0, info->health.failures);
+
+    // the conversion engine skips a quarantined device
+    a.setConnected(false);
+    for (int sweep = 0; sweep < 3; sweep++) sensors.getReading(a.address(), &reading);
+    assertTrue(sensors.isQuarantined(a.address()));
+    sensors.setWaitForConversion(false);
+    assertTrue(sensors.startConversion());
+    while (sensors.tick() != DallasTemperature::CONVERSION_READY) yield();
+    assertEqual(DallasTemperature::READING_QUARANTINED, sensors.getLatestReading(ia)->status);
+    assertEqual(31 * 128, sensors.getLatestReading(1 - ia)->raw);
+}
+
+// Retries asked of getTemp() shrink for a sensor that keeps failing, with
+// quarantine off
+unittest(test_retry_budget) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    a.setTemperature(30);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+
+    a.corruptReads(1000);
+    const uint32_t expected[] = { 4, 4, 2, 1, 1 };
+    for (uint8_t i = 0; i < 5; i++) {
+        uint32_t reads = a.scratchpadReads;
+        assertEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address(), 3));
+        assertEqual(expected[i], a.scratchpadReads - reads);
+    }
+    assertFalse(sensors.isQuarantined(a.address()));
+
+    // recovered, but with a high CRC error rate one retry is left
+    a.corruptReads(0);
+    assertEqual(30 * 128, sensors.getTemp(a.address(), 3));
+    a.corruptReads(2);
+    uint32_t reads = a.scratchpadReads;
+    assertEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address(), 3));
+    assertEqual(2u, a.scratchpadReads - reads);
+
+    // a healthy sensor gets every retry asked for
+    sensors.resetHealth();
+    a.corruptReads(3);
+    reads = a.scratchpadReads;
+    assertEqual(30 * 128, sensors.getTemp(a.address(), 3));
+    assertEqual(4u, a.scratchpadReads - reads);
+}
+#endif
+
+// Fast reads clock two bytes and fall back to a full read when implausible
+unittest(test_fast_read) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18S20 s20(2);
+    a.setTemperature(-10.5);
+    s20.setTemperature(21.5);
+    oneWire.attach(&a);
+    oneWire.attach(&s20);
+
+    static DallasTemperature::DeviceTable<2> pool;
+    DallasTemperature sensors(&oneWire);
+    sensors.setDeviceTable(pool);
+    sensors.begin();
+    sensors.setWaitForConversion(false);
+    assertEqual(DallasTemperature::READ_FULL, sensors.getReadMode());
+    DeviceIndex ia = (memcmp(sensors.getDeviceInfo(0)->address, a.address(), 8) == 0) ? 0 : 1;
+
+    // the power-on value is rejected, the full read still reports it
+    sensors.setReadMode(DallasTemperature::READ_FAST);
+    oneWire.resetStats();
+    assertEqual(85.0, sensors.getTempC(a.address()));
+    assertEqual(11u, oneWire.stats.bytesRead);
+    assertTrue(sensors.getLatestReading(ia)->crcOk);
+    sensors.setReadMode(DallasTemperature::READ_FAST_ONLY);
+    assertEqual(DEVICE_DISCONNECTED_C, sensors.getTempC(a.address()));
+
+    sensors.setWaitForConversion(true);
+    sensors.requestTemperatures();
+    oneWire.resetStats();
+    assertEqual(-10.5, sensors.getTempC(a.address()));
+    assertEqual(2u, oneWire.stats.bytesRead);
+    assertEqual(2u, oneWire.stats.resets);
+    assertFalse(sensors.getLatestReading(ia)->crcOk);
+
+    DallasTemperature::Reading reading;
+    assertTrue(sensors.getReading(a.address(), &reading));
+    assertEqual(-10.5 * 128, reading.raw);
+    assertFalse(reading.crcOk);
+
+    // DS18S20s always need the whole scratchpad
+    oneWire.resetStats();
+    assertEqual(21.5, sensors.getTempC(s20.address()));
+    assertEqual(9u, oneWire.stats.bytesRead);
+    assertTrue(sensors.getLatestReading(1 - ia)->crcOk);
+    assertTrue(sensors.getReading(s20.address(), &reading));
+    assertTrue(reading.crcOk);
+
+    // 0xFFFF is a valid -0.0625 C, confirmed by the full read
+    sensors.setReadMode(DallasTemperature::READ_FAST);
+    a.setTemperature(-0.0625);
+    sensors.requestTemperatures();
+    assertEqual(-0.0625, sensors.getTempC(a.address()));
+    assertTrue(sensors.getLatestReading(ia)->crcOk);
+    assertTrue(sensors.getReading(a.address(), &reading));
+    assertTrue(reading.crcOk);
+    DallasTemperature::Reading all[2];
+    assertEqual(2, sensors.readAll(all, 2));
+    assertTrue(all[ia].crcOk);
+    assertTrue(all[1 - ia].crcOk);
+
+    oneWire.detach(&a);
+    assertEqual(DEVICE_DISCONNECTED_C, sensors.getTempC(a.address()));
+    assertFalse(sensors.getReading(a.address(), &reading));
+    oneWire.detach(&s20);
+    assertFalse(sensors.getReading(a.address(), &reading));
+    assertEqual(DallasTemperature::READING_DISCONNECTED, reading.status);
+}
+
+static unsigned long readAt[3];
+
+static void onTimedTemperature(DeviceIndex index, const uint8_t*, int32_t) {
+    if (index < 3) readAt[index] = millis();
+}
+
+// A scratchpad read failing during begin() leaves the resolution to be
+// read later, not the device written off
+unittest(test_unknown_resolution) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18B20 b(2);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+    DallasTemperature setup(&oneWire);
+    setup.begin();
+    assertTrue(setup.setResolution(a.address(), 9));
+    assertTrue(setup.setResolution(b.address(), 9));
+
+    a.corruptReads(1);
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    const DallasTemperature::DeviceInfo* info = sensors.getDeviceInfo(0);
+    if (memcmp(info->address, a.address(), 8) != 0) info = sensors.getDeviceInfo(1);
+    assertEqual(0, info->resolution);
+    // waits as long as the slowest resolution until it is known
+    assertEqual(12, sensors.getResolution());
+
+    uint32_t reads = a.scratchpadReads;
+    assertTrue(sensors.requestTemperaturesByAddress(a.address()));
+    assertEqual(reads + 1, a.scratchpadReads);
+    assertEqual(9, info->resolution);
+    assertEqual(9, sensors.getResolution());
+    assertNotEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address()));
+
+    // any later scratchpad read fills it in too
+    a.corruptReads(1);
+    sensors.begin();
+    info = sensors.getDeviceInfo(0);
+    if (memcmp(info->address, a.address(), 8) != 0) info = sensors.getDeviceInfo(1);
+    assertEqual(0, info->resolution);
+    sensors.requestTemperatures();
+    assertNotEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address()));
+    assertEqual(9, info->resolution);
+#if REQUIRESSCHEDULE
+    assertTrue(sensors.setSamplePeriod(a.address(), 1000));
+#endif
+}
+
+// Resolution is tracked per device; fast devices are read early
+unittest(test_mixed_resolution) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18B20 b(2);
+    SimDS18B20 c(3);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+    oneWire.attach(&c);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    assertEqual(12, sensors.getResolution());
+    assertTrue(sensors.setResolution(a.address(), 9));
+    assertTrue(sensors.setResolution(b.address(), 9));
+    assertEqual(12, sensors.getResolution());
+    // tiers at datasheet times; test_learned_conversion_time covers the rest
+    sensors.setLearnConversionTime(false);
+
+    uint8_t slow = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        const DallasTemperature::DeviceInfo* info = sensors.getDeviceInfo(i);
+        if (memcmp(info->address, c.address(), 8) == 0) {
+            slow = i;
+            assertEqual(12, info->resolution);
+        } else {
+            assertEqual(9, info->resolution);
+        }
+    }
+
+    // no scratchpad read to learn the wait, and only a 9 bit wait
+    uint32_t reads = a.scratchpadReads;
+    unsigned long start = millis();
+    assertTrue(sensors.requestTemperaturesByAddress(a.address()));
+    assertEqual(reads, a.scratchpadReads);
+    assertLess(millis() - start, 100u);
+
+    sensors.setTemperatureHandler(onTimedTemperature);
+    assertTrue(sensors.startConversion());
+    start = millis();
+    while (sensors.tick() != DallasTemperature::CONVERSION_READY) {
+        delay(1);
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        if (i == slow) {
+            assertMoreOrEqual(readAt[i] - start, 750u);
+        } else {
+            assertMoreOrEqual(readAt[i] - start, 94u);
+            assertLess(readAt[i] - start, 130u);
+        }
+    }
+    sensors.setTemperatureHandler(nullptr);
+
+    assertTrue(sensors.setResolution(c.address(), 10));
+    assertEqual(10, sensors.getResolution());
+    assertEqual(10, sensors.getDeviceInfo(slow)->resolution);
+}
+
+// Polled conversions teach the timed waits how fast the bus really is
+unittest(test_learned_conversion_time) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    oneWire.attach(&a);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    assertTrue(sensors.getLearnConversionTime());
+    assertEqual(750, sensors.millisToWaitForConversion());
+
+    // the simulated devices convert in 80% of the datasheet time
+    sensors.requestTemperatures();
+    uint16_t learned = sensors.millisToWaitForConversion();
+    assertMoreOrEqual(learned, 600u * (100 + CONVERSION_MARGIN_PERCENT) / 100);
+    assertLess(learned, 750u * 9 / 10);
+    assertEqual(750, DallasTemperature::millisToWaitForConversion(12));
+
+    // timed waits use the estimate and still find finished conversions
+    sensors.setCheckForConversion(false);
+    unsigned long start = millis();
+    sensors.requestTemperatures();
+    assertMoreOrEqual(millis() - start, (unsigned long)learned);
+    assertLess(millis() - start, 750u);
+    assertNotEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(a.address()));
+    sensors.setCheckForConversion(true);
+
+    // a slower device raises the estimate at once, faster ones lower it slowly
+    a.setConversionPercent(95);
+    sensors.requestTemperatures();
+    assertMoreOrEqual(sensors.millisToWaitForConversion(), 712u);
+    a.setConversionPercent(50);
+    sensors.requestTemperatures();
+    assertMore(sensors.millisToWaitForConversion(), 600u);
+
+    // other resolutions scale with it
+    sensors.setResolution(9);
+    assertLess(sensors.millisToWaitForConversion(), 94);
+
+    // nothing is learned while the conversion is left alone
+    DallasTemperature timed(&oneWire);
+    timed.begin();
+    timed.setCheckForConversion(false);
+    timed.requestTemperatures();
+    assertEqual(94, timed.millisToWaitForConversion());
+
+    sensors.setLearnConversionTime(false);
+    assertFalse(sensors.getLearnConversionTime());
+    assertEqual(94, sensors.millisToWaitForConversion());
+}
+
+// Polling one fast device never shortens the wait for a slower one
+unittest(test_learned_conversion_time_mixed) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1), b(2);
+    a.setConversionPercent(50);
+    b.setConversionPercent(95);
+    a.setTemperature(10);
+    b.setTemperature(10);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    // a single device's time is not the bus's
+    sensors.requestTemperaturesByAddress(a.address());
+    assertEqual(750, sensors.millisToWaitForConversion());
+
+    sensors.requestTemperatures();
+    uint16_t learned = sensors.millisToWaitForConversion();
+    assertMoreOrEqual(learned, 712u);
+    for (int i = 0; i < 40; i++) sensors.requestTemperaturesByAddress(a.address());
+    assertEqual(learned, sensors.millisToWaitForConversion());
+
+    // the timed wait still covers the slow device
+    a.setTemperature(30);
+    b.setTemperature(30);
+    sensors.setCheckForConversion(false);
+    sensors.requestTemperatures();
+    assertEqual(30.0, sensors.getTempC(b.address()));
+    assertEqual(30.0, sensors.getTempC(a.address()));
+}
+
+#if REQUIRESROLLING
+static uint32_t rollingReads;
+static uint32_t rollingBad;
+static int32_t rollingExpected;
+
+static void onRollingTemperature(DeviceIndex, const uint8_t*, int32_t raw) {
+    rollingReads++;
+    if (raw != rollingExpected) rollingBad++;
+}
+
+static void setRollingTemperature(std::vector<SimDS18B20*>& devices, int8_t celsius) {
+    for (size_t i = 0; i < devices.size(); i++) devices[i]->setTemperature(celsius);
+    rollingExpected = celsius * 128;
+}
+
+// Samples delivered by tick() in ten seconds of simulated time
+static uint32_t samplesIn10s(DallasTemperature& sensors, bool rolling) {
+    rollingReads = 0;
+    rollingBad = 0;
+    sensors.setTemperatureHandler(onRollingTemperature);
+    if (rolling) {
+        assertTrue(sensors.startRolling());
+    } else {
+        assertTrue(sensors.startConversion());
+    }
+    unsigned long start = millis();
+    while (millis() - start < 10000) {
+        DallasTemperature::conversion_state_t state = sensors.tick();
+        if (state == DallasTemperature::CONVERSION_READY) sensors.startConversion();
+        yield();
+    }
+    sensors.setTemperatureHandler(nullptr);
+    sensors.stopRolling();
+    while (sensors.getConversionState() == DallasTemperature::CONVERSION_CONVERTING ||
+           sensors.getConversionState() == DallasTemperature::CONVERSION_READING) {
+        sensors.tick();
+        yield();
+    }
+    return rollingReads;
+}
+
+// Staggered addressed conversions keep the bus busy while others convert
+unittest(test_rolling_conversion) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint8_t i = 0; i < 32; i++) {
+        devices.push_back(new SimDS18B20(0x100 + i));
+        oneWire.attach(devices[i]);
+    }
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.requestTemperatures();
+
+    // a reading taken before its conversion ended would be stale
+    setRollingTemperature(devices, 25);
+    uint32_t broadcast = samplesIn10s(sensors, false);
+    assertEqual(0u, rollingBad);
+    setRollingTemperature(devices, 26);
+    oneWire.resetStats();
+    uint32_t rolling = samplesIn10s(sensors, true);
+    assertEqual(0u, rollingBad);
+    // about 32 against 42 samples per second, the bus busy 80% of the time
+    assertMore(rolling * 10, broadcast * 12);
+    assertMore(oneWire.stats.busMicros, 7500000ull);
+
+    // groups are cut again for the rescanned table
+    oneWire.detach(devices[31]);
+    sensors.rescan();
+    assertEqual(31, sensors.getDeviceCount());
+    setRollingTemperature(devices, 27);
+    assertMore(samplesIn10s(sensors, true), broadcast);
+    assertEqual(0u, rollingBad);
+
+    // parasite buses need the bus left alone while converting
+    devices[0]->setParasite(true);
+    sensors.begin();
+    assertFalse(sensors.startRolling());
+
+    for (uint8_t i = 0; i < 32; i++) delete devices[i];
+}
+#endif
+
+#if REQUIRESSCHEDULE
+static uint32_t sampleCount[34];
+static unsigned long sampleLast[34];
+static unsigned long sampleMaxGap[34];
+
+static void onScheduledTemperature(DeviceIndex index, const uint8_t*, int32_t raw) {
+    if (index >= 34 || raw == DEVICE_DISCONNECTED_RAW) return;
+    unsigned long now = millis();
+    if (sampleCount[index] > 0 && now - sampleLast[index] > sampleMaxGap[index]) {
+        sampleMaxGap[index] = now - sampleLast[index];
+    }
+    sampleLast[index] = now;
+    sampleCount[index]++;
+}
+
+// Thirty seconds of four 2 Hz sensors and thirty 0.1 Hz ones
+static void runSchedule(DallasTemperature& sensors) {
+    memset(sampleCount, 0, sizeof(sampleCount));
+    memset(sampleMaxGap, 0, sizeof(sampleMaxGap));
+    for (DeviceIndex i = 0; i < 34; i++) {
+        assertTrue(sensors.setSamplePeriodByIndex(i, i < 4 ? 500 : 10000, i < 4 ? 1 : 0));
+    }
+    sensors.setTemperatureHandler(onScheduledTemperature);
+    assertTrue(sensors.startScheduler());
+    assertFalse(sensors.startConversion());
+    unsigned long start = millis();
+    while (millis() - start < 30000) {
+        sensors.tick();
+        yield();
+    }
+    assertEqual(DallasTemperature::CONVERSION_SCHEDULED, sensors.getConversionState());
+    sensors.stopScheduler();
+    sensors.setTemperatureHandler(nullptr);
+}
+
+// Each sensor is sampled at its own rate, due sensors only
+unittest(test_scheduler) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint8_t i = 0; i < 34; i++) {
+        devices.push_back(new SimDS18B20(0x300 + i));
+        oneWire.attach(devices[i]);
+    }
+
+    DallasTemperature sensors(&oneWire);
+    DallasTemperature::DeviceTable<34> table;
+    sensors.setDeviceTable(table);
+    sensors.begin();
+    assertFalse(sensors.setSamplePeriodByIndex(34, 500));
+    // 2 Hz needs a conversion shorter than 500 ms
+    for (DeviceIndex i = 0; i < 4; i++) {
+        assertTrue(sensors.setResolution(table.devices[i].address, 11));
+    }
+
+    oneWire.resetStats();
+    runSchedule(sensors);
+    uint64_t busMicros = oneWire.stats.busMicros;
+    for (uint8_t i = 0; i < 4; i++) {
+        assertMoreOrEqual(sampleCount[i], 59u);
+        assertLessOrEqual(sampleMaxGap[i], 520u);
+    }
+    for (uint8_t i = 4; i < 34; i++) {
+        assertEqual(3u, sampleCount[i]);
+        assertLessOrEqual(sampleMaxGap[i], 10100u);
+    }
+    // under a fifth of the bus, where a 2 Hz sweep of all 34 takes three quarters
+    assertLess(busMicros, 30000000ull / 5);
+
+    // the ambient sensors, due together, share one broadcast conversion
+    sensors.setBroadcastPercent(101);
+    oneWire.resetStats();
+    runSchedule(sensors);
+    assertMore(oneWire.stats.busMicros, busMicros + 3 * 25 * 5000ull);
+    assertEqual(3u, sampleCount[33]);
+
+    sensors.setSamplePeriodByIndex(0, 0);
+    assertTrue(sensors.startScheduler());
+    sensors.stopScheduler();
+    assertEqual(DallasTemperature::CONVERSION_IDLE, sensors.getConversionState());
+
+    for (uint8_t i = 0; i < 34; i++) delete devices[i];
+}
+#endif
+
+// Deferred edits reach each device once, with a single EEPROM copy
+unittest(test_deferred_writes) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDS18B20*> devices;
+    for (uint64_t i = 0; i < 30; i++) {
+        devices.push_back(new SimDS18B20(0x2000 + i * 104729));
+        oneWire.attach(devices.back());
+    }
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.setDeferredWrites(true);
+
+    DeviceAddress addr;
+    for (uint8_t i = 0; i < 30; i++) {
+        assertTrue(sensors.getAddress(addr, i));
+        sensors.setHighAlarmTemp(addr, i == 0 ? 41 : 40);
+        sensors.setLowAlarmTemp(addr, -5);
+        sensors.setResolution(addr, 10, true);
+    }
+    assertEqual(0u, devices[0]->scratchpadWrites);
+    assertEqual(40, sensors.getHighAlarmTemp(addr));
+    assertEqual(10, sensors.getResolution(addr));
+
+    oneWire.resetStats();
+    assertEqual(30, sensors.commit());
+    assertEqual(0, sensors.commit());
+    // device 0 differs, so 30 writes plus one broadcast copy and its closing reset
+    assertEqual(32u, oneWire.stats.resets);
+
+    for (uint8_t i = 0; i < 30; i++) {
+        assertEqual(1u, devices[i]->scratchpadWrites);
+        assertEqual(1u, devices[i]->eepromWrites);
+        assertEqual(i == 0 ? 41 : 40, devices[i]->eeprom()[0]);
+        assertEqual(0xFB, devices[i]->eeprom()[1]);
+        assertEqual(0x3F, devices[i]->eeprom()[2]);
+    }
+
+    // one changed device is copied on its own
+    sensors.setUserData(devices[3]->address(), 0x1234);
+    sensors.setUserData(devices[3]->address(), 0x1234);
+    sensors.setDeferredWrites(false);
+    assertEqual(2u, devices[3]->eepromWrites);
+    assertEqual(1u, devices[4]->eepromWrites);
+    assertEqual(0x1234, sensors.getUserData(devices[3]->address()));
+
+    // unchanged values are not written at all
+    sensors.setUserData(devices[3]->address(), 0x1234);
+    assertEqual(2u, devices[3]->scratchpadWrites);
+
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+// Uniform settings go out as one Skip ROM write and one copy
+unittest(test_broadcast_configuration) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    std::vector<SimDevice*> devices;
+    for (uint64_t i = 0; i < 20; i++) {
+        devices.push_back(i == 7 ? (SimDevice*)new SimDS1822(0x3000 + i * 7)
+                                 : (SimDevice*)new SimDS18B20(0x3000 + i * 7));
+        oneWire.attach(devices.back());
+    }
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+
+    oneWire.resetStats();
+    sensors.setResolution(9);
+    assertEqual(3u, oneWire.stats.resets);
+    for (size_t i = 0; i < devices.size(); i++) {
+        assertEqual(1u, devices[i]->eepromWrites);
+        assertEqual(0x1F, devices[i]->eeprom()[2]);
+    }
+    assertEqual(9, sensors.getResolution(devices[7]->address()));
+
+    // deferred edits that end up identical are broadcast as well
+    sensors.setDeferredWrites(true);
+    DeviceAddress addr;
+    for (uint8_t i = 0; i < 20; i++) {
+        sensors.getAddress(addr, i);
+        sensors.setHighAlarmTemp(addr, 50);
+    }
+    oneWire.resetStats();
+    assertEqual(20, sensors.commit());
+    assertEqual(3u, oneWire.stats.resets);
+    assertEqual(50, devices[19]->eeprom()[0]);
+    sensors.setDeferredWrites(false);
+
+    // differing alarm bytes fall back to per-device writes
+    sensors.setHighAlarmTemp(devices[0]->address(), 60);
+    oneWire.resetStats();
+    sensors.setResolution(12);
+    assertMoreOrEqual(oneWire.stats.resets, 40u);
+    assertEqual(0x7F, devices[0]->eeprom()[2]);
+    assertEqual(60, devices[0]->eeprom()[0]);
+    assertEqual(50, devices[1]->eeprom()[0]);
+
+    // a DS18S20 has no configuration byte, so it is never broadcast to
+    SimDS18S20 s20(0x4000);
+    oneWire.attach(&s20);
+    sensors.begin();
+    sensors.setHighAlarmTemp(devices[0]->address(), 50);
+    oneWire.resetStats();
+    sensors.setResolution(11);
+    assertMoreOrEqual(oneWire.stats.resets, 40u);
+    assertEqual(0x5F, devices[3]->eeprom()[2]);
+
+    oneWire.detach(&s20);
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+// Devices a family search passes over must not get Skip ROM commands
+unittest(test_broadcast_mixed_bus) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18B20 b(2);
+    SimDS18B20 c(3);
+    SimSwitch ds2438(4, 0x26);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+    oneWire.attach(&c);
+    oneWire.attach(&ds2438);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.setFamilySearch(true);
+    sensors.begin();
+    assertEqual(3, sensors.getDeviceCount());
+
+    sensors.setResolution(10);
+    assertEqual(0u, ds2438.functions);
+    assertEqual(0x3F, a.eeprom()[2]);
+    assertEqual(0x3F, c.eeprom()[2]);
+
+    sensors.setDeferredWrites(true);
+    sensors.setHighAlarmTemp(a.address(), 40);
+    sensors.setHighAlarmTemp(b.address(), 40);
+    sensors.setHighAlarmTemp(c.address(), 40);
+    assertEqual(3, sensors.commit());
+    assertEqual(0u, ds2438.functions);
+    assertEqual(40, b.eeprom()[0]);
+    sensors.setDeferredWrites(false);
+
+    // a warm start remembers the other devices
+    FileStorage storage;
+    assertTrue(sensors.saveDeviceTable(&storage));
+    DallasTemperature warm(&oneWire);
+    warm.setFamilySearch(true);
+    assertTrue(warm.begin(&storage));
+    warm.setResolution(11);
+    assertEqual(0u, ds2438.functions);
+
+#if REQUIRESSCHEDULE
+    // nor does the scheduler convert them with a broadcast
+    for (DeviceIndex i = 0; i < 3; i++) assertTrue(sensors.setSamplePeriodByIndex(i, 1000));
+    assertTrue(sensors.startScheduler());
+    unsigned long start = millis();
+    while (millis() - start < 2000) {
+        sensors.tick();
+        yield();
+    }
+    sensors.stopScheduler();
+    assertEqual(0u, ds2438.functions);
+#endif
+
+    // without the other device the bus is broadcast to again
+    oneWire.detach(&ds2438);
+    sensors.begin();
+    oneWire.resetStats();
+    sensors.setResolution(9);
+    assertEqual(3u, oneWire.stats.resets);
+}
+
+#if REQUIRESBUSSTATS
+// A clock that sleeps a millisecond between polls, counting its waits
+class SleepingClock : public DallasTemperature::Clock {
+public:
+    SleepingClock() : offset(0), waited(0), idles(0) {}
+    unsigned long now(void) { return offset + millis(); }
+    void wait(unsigned long ms) { waited += ms; delay(ms); }
+    void idle(void) { idles++; delay(1); }
+    unsigned long offset;
+    unsigned long waited;
+    uint32_t idles;
+};
+
+// Every timestamp and wait goes through the clock
+unittest(test_clock) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    oneWire.attach(&a);
+    SleepingClock clock;
+    clock.offset = 1000000;
+
+    DallasTemperature sensors(&oneWire);
+    sensors.setClock(&clock);
+    assertEqual(&clock, sensors.getClock());
+    sensors.begin();
+    assertEqual((unsigned long)INITIALIZATION_DELAY_MS, clock.waited);
+
+    DallasTemperature::Reading reading;
+    sensors.requestTemperatures();
+    assertTrue(sensors.getReading(a.address(), &reading));
+    assertMoreOrEqual(reading.timestamp, clock.offset);
+
+    // polling once per millisecond instead of spinning
+    DallasTemperature spinning(&oneWire);
+    spinning.begin();
+    oneWire.resetStats();
+    spinning.requestTemperatures();
+    uint32_t spinPolls = oneWire.stats.bitsRead;
+
+    oneWire.resetStats();
+    sensors.requestTemperatures();
+    assertMore(clock.idles, 0u);
+    assertLessOrEqual(oneWire.stats.bitsRead, clock.idles + 1);
+    assertLess(oneWire.stats.bitsRead * 10, spinPolls);
+
+    a.setParasite(true);
+    sensors.rescan();
+    clock.waited = 0;
+    assertTrue(sensors.saveScratchPad(a.address()));
+    assertEqual((unsigned long)MAX_EEPROM_WRITE_TIME, clock.waited);
+
+    sensors.setClock(nullptr);
+    assertEqual(nullptr, sensors.getClock());
+}
+
+unittest(test_bus_stats) {
+    OneWire oneWire(ONE_WIRE_BUS);
+    SimDS18B20 a(1);
+    SimDS18B20 b(2);
+    oneWire.attach(&a);
+    oneWire.attach(&b);
+
+    DallasTemperature sensors(&oneWire);
+    sensors.begin();
+    sensors.resetBusStats();
+    oneWire.resetStats();
+
+    const uint8_t* addr = a.address();
+    sensors.requestTemperatures();
+    sensors.getTempC(addr);
+    DallasTemperature::BusStats stats = sensors.getBusStats();
+    assertEqual(oneWire.stats.resets, stats.resets);
+    assertEqual(oneWire.stats.bytesWritten, stats.bytesWritten);
+    assertEqual(oneWire.stats.bytesRead, stats.bytesRead);
+    assertEqual(0u, stats.presenceFailures);
+    assertMoreOrEqual(stats.conversionWaitMillis, 590u);
+    assertLess(stats.conversionWaitMillis, 760u);
+
+    // two corrupted reads use up two retries
+    a.corruptReads(2);
+    assertNotEqual(DEVICE_DISCONNECTED_RAW, sensors.getTemp(addr, 3));
+    stats = sensors.getBusStats();
+    assertEqual(2u, stats.crcErrors);
+    assertEqual(2u, stats.retries);
+
+    sensors.saveScratchPad();
+    assertEqual(20u, sensors.getBusStats().eepromWaitMillis);
+
+    oneWire.detach(&a);
+    oneWire.detach(&b);
+    sensors.getTempC(addr);
+    assertEqual(1u, sensors.getBusStats().presenceFailures);
+
+    sensors.resetBusStats();
+    stats = sensors.getBusStats();
+    assertEqual(0u, stats.resets);
+    assertEqual(0u, stats.crcErrors);
+    assertEqual(0u, stats.conversionWaitMillis);
+}
+#endif
+
+unittest_main()
@@ -0,0 +1,136 @@
+//    FILE: test_DallasTemperatureGroup.cpp
+// PURPOSE: conversions overlapped across several simulated buses
+
+#include <ArduinoUnitTests.h>
+#include <Arduino.h>
+#include <OneWire.h>
+#include <DallasTemperatureGroup.h>
+
+unittest(test_group_sweep) {
+    OneWire oneWire[3] = { 2, 3, 4 };
+    SimDS18B20 a(1), b(2), c(3), d(4);
+    SimDS18S20 s20(5);
+    c.setParasite(true);
+    a.setTemperature(1);
+    b.setTemperature(2);
+    c.setTemperature(3);
+    d.setTemperature(4);
+    s20.setTemperature(5);
+    oneWire[0].attach(&a);
+    oneWire[0].attach(&b);
+    oneWire[1].attach(&c);
+    oneWire[2].attach(&d);
+    oneWire[2].attach(&s20);
+
+    DallasTemperature sensors[] = { &oneWire[0], &oneWire[1], &oneWire[2] };
+    DallasTemperatureGroup group(sensors, 3);
+    group.begin();
+    assertEqual(3, group.getBusCount());
+    assertEqual(5, group.getDeviceCount());
+
+    // one conversion time for all buses, not three
+    unsigned long start = millis();
+    group.requestTemperatures();
+    assertLess(millis() - start, 800u);
+
+    DallasTemperature::Reading readings[5];
+    assertEqual(5, group.readAll(readings, 5));
+    float sum = 0;
+    for (uint8_t i = 0; i < 5; i++) {
+        assertEqual(DallasTemperature::READING_OK, readings[i].status);
+        sum += DallasTemperature::rawToCelsius(readings[i].raw);
+    }
+    assertEqualFloat(15, sum, 0.1);
+}
+
+unittest(test_group_async) {
+    OneWire oneWire[2] = { 2, 3 };
+    SimDS18B20 a(1), b(2);
+    oneWire[0].attach(&a);
+    oneWire[1].attach(&b);
+
+    DallasTemperature sensors[] = { &oneWire[0], &oneWire[1] };
+    DallasTemperatureGroup group(sensors, 2);
+    group.begin();
+    group.setWaitForConversion(false);
+    group.requestTemperatures();
+    assertFalse(group.isConversionComplete());
+    delay(750);
+    assertTrue(group.isConversionComplete());
+
+    // fewer slots than devices
+    DallasTemperature::Reading readings[1];
+    assertEqual(1, group.readAll(readings, 1));
+    assertEqual(DallasTemperature::CONVERSION_IDLE, sensors[0].getConversionState());
+
+    // a new sweep may start before the last one was read
+    assertTrue(group.requestTemperatures());
+    delay(750);
+    assertTrue(group.isConversionComplete());
+    assertTrue(group.requestTemperatures());
+}
+
+// Devices of mixed resolutions are read once per sweep, by readAll()
+unittest(test_group_mixed_resolution) {
+    OneWire oneWire[2] = { 2, 3 };
+    SimDS18B20 a(1), b(2), c(3);
+    oneWire[0].attach(&a);
+    oneWire[0].attach(&b);
+    oneWire[1].attach(&c);
+
+    DallasTemperature sensors[] = { &oneWire[0], &oneWire[1] };
+    DallasTemperatureGroup group(sensors, 2);
+    group.begin();
+    assertTrue(sensors[0].setResolution(a.address(), 9));
+    assertTrue(sensors[0].setResolution(b.address(), 12));
+
+    uint32_t readsA = a.scratchpadReads;
+    uint32_t readsB = b.scratchpadReads;
+    assertTrue(group.requestTemperatures());
+    DallasTemperature::Reading readings[3];
+    assertEqual(3, group.readAll(readings, 3));
+    assertEqual(readsA + 1, a.scratchpadReads);
+    assertEqual(readsB + 1, b.scratchpadReads);
+    for (uint8_t i = 0; i < 3; i++) assertEqual(DallasTemperature::READING_OK, readings[i].status);
+}
+
+// A parasite bus keeps its strong pullup and sees no traffic while the
+// group polls the others; the buses' own wait setting is left alone
+unittest(test_group_parasite) {
+    const uint8_t PULLUP_PIN = 6;
+    OneWire oneWire[2] = { 2, 3 };
+    SimDS18B20 a(1), b(2);
+    b.setParasite(true);
+    a.setTemperature(20);
+    b.setTemperature(21);
+    oneWire[0].attach(&a);
+    oneWire[1].attach(&b);
+
+    DallasTemperature sensors[] = { &oneWire[0], DallasTemperature(&oneWire[1], PULLUP_PIN) };
+    DallasTemperatureGroup group(sensors, 2);
+    group.begin();
+    assertTrue(sensors[1].getWaitForConversion());
+    assertTrue(sensors[1].isParasitePowerMode());
+    group.setWaitForConversion(false);
+
+    assertTrue(group.requestTemperatures());
+    oneWire[1].resetStats();
+    oneWire[0].resetStats();
+    uint32_t pulledUp = 0;
+    while (!group.isConversionComplete()) {
+        assertEqual(LOW, digitalRead(PULLUP_PIN));
+        pulledUp++;
+        delay(1);
+    }
+    assertMore(pulledUp, 500u);
+    assertEqual(HIGH, digitalRead(PULLUP_PIN));
+    assertEqual(0u, oneWire[1].stats.resets);
+    assertMore(oneWire[0].stats.bitsRead, 0u);
+
+    DallasTemperature::Reading readings[2];
+    assertEqual(2, group.readAll(readings, 2));
+    assertEqual(20 * 128, readings[0].raw);
+    assertEqual(21 * 128, readings[1].raw);
+}
+
+unittest_main()
@@ -0,0 +1,183 @@
+//    FILE: test_simulator.cpp
+// PURPOSE: checks of the simulated 1-Wire bus itself, so the library tests
+//          can trust it
+
+#include <ArduinoUnitTests.h>
+#include <Arduino.h>
+#include <OneWire.h>
+#include <vector>
+
+// ROM search finds every device once, collisions included
+unittest(test_search_finds_all) {
+    OneWire oneWire(2);
+    std::vector<SimDevice*> devices;
+    for (uint64_t i = 0; i < 100; i++) {
+        devices.push_back(new SimDS18B20(i * 0x9E3779B97F4Aull));
+        oneWire.attach(devices.back());
+    }
+    // two ROMs one bit apart
+    devices.push_back(new SimDS18B20(0x100));
+    devices.push_back(new SimDS18B20(0x101));
+    oneWire.attach(devices[100]);
+    oneWire.attach(devices[101]);
+
+    uint8_t addr[8];
+    int found = 0;
+    oneWire.reset_search();
+    while (oneWire.search(addr)) {
+        assertEqual(addr[7], OneWire::crc8(addr, 7));
+        found++;
+    }
+    assertEqual(102, found);
+
+    for (size_t i = 0; i < devices.size(); i++) delete devices[i];
+}
+
+unittest(test_target_search) {
+    OneWire oneWire(2);
+    SimDS18B20 b20(1);
+    SimSwitch ds2413(2);
+    SimDS18S20 s20(3);
+    oneWire.attach(&b20);
+    oneWire.attach(&ds2413);
+    oneWire.attach(&s20);
+
+    uint8_t addr[8];
+    oneWire.target_search(0x3A);
+    assertTrue(oneWire.search(addr));
+    assertEqual(0x3A, addr[0]);
+}
+
+unittest(test_presence) {
+    OneWire oneWire(2);
+    assertEqual(0, oneWire.reset());
+    assertEqual(1u, oneWire.stats.presenceFailures);
+
+    SimDS18B20 device(1);
+    oneWire.attach(&device);
+    assertEqual(1, oneWire.reset());
+    device.setConnected(false);
+    assertEqual(0, oneWire.reset());
+}
+
+// Slot durations follow the OneWire library at standard speed
+unittest(test_slot_timing) {
+    OneWire oneWire(2);
+    SimDS18B20 device(1);
+    oneWire.attach(&device);
+
+    uint64_t start = simMicros;
+    oneWire.reset();
+    assertEqual(960u, (unsigned)(simMicros - start));
+
+    start = simMicros;
+    oneWire.write(0xFF);
+    assertEqual(8u * 65, (unsigned)(simMicros - start));
+
+    start = simMicros;
+    oneWire.read();
+    assertEqual(8u * 66, (unsigned)(simMicros - start));
+    assertEqual(oneWire.stats.busMicros, (uint64_t)(960 + 8 * 65 + 8 * 66));
+}
+
+unittest(test_scratchpad_and_eeprom) {
+    OneWire oneWire(2);
+    SimDS18B20 device(1);
+    oneWire.attach(&device);
+
+    // power-on scratchpad holds 85 C
+    assertEqual(0x50, device.scratchpad()[0]);
+    assertEqual(0x05, device.scratchpad()[1]);
+
+    oneWire.reset();
+    oneWire.select(device.address());
+    oneWire.write(0x4E);
+    oneWire.write(10);
+    oneWire.write(5);
+    oneWire.write(0x1F);
+    assertEqual(9, device.resolution());
+    assertEqual(OneWire::crc8(device.scratchpad(), 8), device.scratchpad()[8]);
+    assertEqual(75, device.eeprom()[0]);
+
+    oneWire.reset();
+    oneWire.skip();
+    oneWire.write(0x48);
+    assertEqual(10, device.eeprom()[0]);
+    assertEqual(0x1F, device.eeprom()[2]);
+    // externally powered devices report the copy in progress
+    assertEqual(0, oneWire.read_bit());
+    delay(10);
+    assertEqual(1, oneWire.read_bit());
+}
+
+unittest(test_conversion_time) {
+    OneWire oneWire(2);
+    SimDS18B20 device(1);
+    device.setTemperature(25.0625);
+    device.setConversionPercent(100);
+    oneWire.attach(&device);
+
+    oneWire.reset();
+    oneWire.skip();
+    oneWire.write(0x44);
+    assertEqual(0, oneWire.read_bit());
+    delay(740);
+    assertEqual(0, oneWire.read_bit());
+    delay(10);
+    assertEqual(1, oneWire.read_bit());
+    assertEqual(1u, device.conversions);
+    assertEqual(0x91, device.scratchpad()[0]);
+    assertEqual(0x01, device.scratchpad()[1]);
+}
+
+// Parasite devices need the strong pullup for the whole conversion
+unittest(test_parasite_power) {
+    OneWire oneWire(2);
+    SimDS18B20 device(1);
+    device.setParasite(true);
+    device.setTemperature(20);
+    oneWire.attach(&device);
+
+    oneWire.reset();
+    oneWire.skip();
+    oneWire.write(0x44);
+    delay(750);
+    oneWire.reset();
+    assertEqual(0u, device.conversions);
+    assertEqual(0x50, device.scratchpad()[0]);
+
+    oneWire.skip();
+    oneWire.write(0x44, 1);
+    delay(100);
+    oneWire.reset();
+    assertEqual(0u, device.conversions);
+
+    oneWire.skip();
+    oneWire.write(0x44, 1);
+    delay(750);
+    oneWire.reset();
+    assertEqual(1u, device.conversions);
+    assertEqual(0x40, device.scratchpad()[0]);
+    assertEqual(0x01, device.scratchpad()[1]);
+}
+
+unittest(test_read_power_supply) {
+    OneWire oneWire(2);
+    SimDS18B20 external(1);
+    SimDS18B20 parasite(2);
+    parasite.setParasite(true);
+    oneWire.attach(&external);
+    oneWire.attach(&parasite);
+
+    oneWire.reset();
+    oneWire.select(external.address());
+    oneWire.write(0xB4);
+    assertEqual(1, oneWire.read_bit());
+
+    oneWire.reset();
+    oneWire.skip();
+    oneWire.write(0xB4);
+    assertEqual(0, oneWire.read_bit());
+}
+
+unittest_main()